@@ -49,8 +49,17 @@ class Registry {
         }
 
         uint32_t CreateEntity() {
+            // Reuse removed IDs so the sparse arrays stop growing under constant churn
+            if(!mFreeEntities.empty()) {
+                const uint32_t id = mFreeEntities.back();
+                mFreeEntities.pop_back();
+                mFree[id] = false;
+                return id;
+            }
+
             const uint32_t id = mEntities.size();
             mEntities.emplace_back();
+            mFree.push_back(false);
             return id;
         }
 
@@ -95,8 +104,12 @@ class Registry {
         }
 
         void RemoveEntity(size_t entityID) {
-            if (entityID >= mEntities.size()) return;
-            
+            if (entityID >= mEntities.size() || mFree[entityID]) return;
+
+            // Entities without components are recycled too, a second remove is a no-op
+            mFree[entityID] = true;
+            mFreeEntities.push_back(entityID);
+
             uint64_t mask = mEntities[entityID];
             while (mask) {
                 const size_t idx = std::countr_zero(mask);
@@ -146,6 +159,8 @@ class Registry {
         std::unordered_map<std::type_index, std::shared_ptr<void>> mSingletons;
         
         std::vector<uint64_t> mEntities; // Component bitmask per entity
+        std::vector<uint32_t> mFreeEntities;
+        std::vector<bool> mFree; // Per entity, true while its ID waits in mFreeEntities
         std::vector<std::unique_ptr<ISparseSet>> mComponentPool;
 };
 
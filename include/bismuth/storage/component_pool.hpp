@@ -7,11 +7,22 @@
 #include <limits>
 #include <cstdint>
 
+// Own libraries
+#include "./bismuth/storage/default_init_allocator.hpp"
+
 namespace bismuth {
 
 using EntityID = uint32_t;
 static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
 
+// Runs body(begin, end) over the whole range on the calling thread
+struct SerialFor {
+    template<typename Body>
+    void operator()(size_t begin, size_t end, const Body& body) const {
+        body(begin, end);
+    }
+};
+
 class ISparseSet {
     public:
         using EntityID = uint32_t;
@@ -23,6 +34,7 @@ class ISparseSet {
 template<typename ComponentType>
 class ComponentPool : public ISparseSet{
     public:
+        using ComponentArray = std::vector<ComponentType, DefaultInitAllocator<ComponentType>>;
 
         inline ComponentType& GetComponent(const EntityID& entity) {
             assert(HasComponent(entity) && "No entity with such component");
@@ -83,6 +95,45 @@ class ComponentPool : public ISparseSet{
             mComponentLocation[entity] = INVALID_INDEX;
         }
 
+        // Rearranges the dense arrays to follow entityOrder, which must hold every entity of the pool once.
+        // parallelFor(begin, end, body) splits the copy, the new array is first written inside it
+        template<typename ParallelFor = SerialFor>
+        void Reorder(const std::vector<uint32_t>& entityOrder, const ParallelFor& parallelFor = ParallelFor()) {
+            assert(entityOrder.size() == mDenseEntities.size() && "Order does not cover the pool");
+
+            ComponentArray components;
+            components.resize(mDenseComponents.size());
+
+            parallelFor(0, entityOrder.size(), [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++) {
+                    assert(HasComponent(entityOrder[i]) && "No entity with such component");
+                    components[i] = std::move(mDenseComponents[mComponentLocation[entityOrder[i]]]);
+                }
+            });
+            for(size_t i = 0; i < entityOrder.size(); i++) {
+                mComponentLocation[entityOrder[i]] = i;
+            }
+
+            mDenseComponents.swap(components);
+            mDenseEntities = entityOrder;
+        }
+
+        // Moves the dense components into fresh storage first written inside parallelFor, so with
+        // first-touch page placement each range lands on the memory node of the thread that copied it
+        template<typename ParallelFor>
+        void FirstTouch(const ParallelFor& parallelFor) {
+            ComponentArray components;
+            components.resize(mDenseComponents.size());
+
+            parallelFor(0, components.size(), [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++) {
+                    components[i] = std::move(mDenseComponents[i]);
+                }
+            });
+
+            mDenseComponents.swap(components);
+        }
+
         inline void Reserve(const size_t& capacity) {
             mComponentLocation.resize(capacity+1, INVALID_INDEX);
             mDenseComponents.reserve(capacity);
@@ -90,7 +141,7 @@ class ComponentPool : public ISparseSet{
         }
 
         // For efficient reading/sending data to gpu
-        const std::vector<ComponentType>& GetDenseComponents() const {
+        const ComponentArray& GetDenseComponents() const {
             return mDenseComponents;
         }
         const std::vector<uint32_t>& GetDenseEntities() const noexcept{
@@ -100,16 +151,16 @@ class ComponentPool : public ISparseSet{
             return mComponentLocation;
         }
 
-        std::vector<ComponentType>::iterator ComponentBegin() {
+        ComponentArray::iterator ComponentBegin() {
             return mDenseComponents.begin();
         }
-        std::vector<ComponentType>::iterator ComponentEnd() {
+        ComponentArray::iterator ComponentEnd() {
             return mDenseComponents.end();
         }
 
     private:
         std::vector<uint32_t> mComponentLocation;
-        std::vector<ComponentType> mDenseComponents;
+        ComponentArray mDenseComponents;
         std::vector<uint32_t> mDenseEntities;
 };
 
@@ -0,0 +1,34 @@
+#pragma  once
+// C++ standard libraries
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace bismuth {
+
+// resize() default-initializes instead of value-initializing, so plain data is left unwritten
+// and its pages are first touched by whichever thread fills them in
+template<typename T, typename Base = std::allocator<T>>
+class DefaultInitAllocator : public Base {
+    public:
+        using Traits = std::allocator_traits<Base>;
+
+        template<typename U>
+        struct rebind {
+            using other = DefaultInitAllocator<U, typename Traits::template rebind_alloc<U>>;
+        };
+
+        using Base::Base;
+
+        template<typename U>
+        void construct(U* pointer) noexcept(std::is_nothrow_default_constructible_v<U>) {
+            ::new(static_cast<void*>(pointer)) U;
+        }
+
+        template<typename U, typename... Args>
+        void construct(U* pointer, Args&&... args) {
+            Traits::construct(static_cast<Base&>(*this), pointer, std::forward<Args>(args)...);
+        }
+};
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+// C++ standard libraries
+#include <cstddef>
+#include <vector>
+
+namespace quartz {
+
+// Memory nodes and the cpus of each that this process may run on.
+// Without NUMA information (other systems, containers) it reports a single node with every cpu
+class NumaTopology {
+    public:
+        static const NumaTopology& Get();
+
+        size_t GetNodeCount() const;
+        const std::vector<unsigned int>& GetNodeCpus(size_t node) const;
+        // Node after node, the order workers are placed in
+        std::vector<unsigned int> GetCpus() const;
+        // Contiguous slice share of shareCount of GetCpus(), for processes sharing the machine
+        std::vector<unsigned int> GetCpuShare(unsigned int share, unsigned int shareCount) const;
+        size_t GetNodeOfCpu(unsigned int cpu) const;
+
+        // Pins the calling thread, false if the system refused or does not support it
+        static bool PinThread(unsigned int cpu);
+
+    private:
+        NumaTopology();
+
+    private:
+        std::vector<std::vector<unsigned int>> mNodeCpus;
+};
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace quartz {
+
+// Fork-join pool with one deque per worker. A parallel loop is cut into chunks that are
+// dealt out as contiguous blocks (locality), owners pop from the back, idle workers steal
+// from the front of others' deques (load balance).
+// Pinned workers are placed node after node, so the same index range of every loop runs on
+// the same memory node, and they steal from workers of their own node first.
+// A loop started from inside a loop body runs serially on the calling thread. The first
+// exception thrown by a body is rethrown to the caller once the loop finished
+class TaskPool {
+    public:
+        using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+        // Worker i is pinned to cpus[i * cpus.size() / threadCount], empty = not pinned
+        explicit TaskPool(unsigned int threadCount, const std::vector<unsigned int>& cpus = {});
+        ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        // Shared pool used by the simulation systems
+        static TaskPool& Get();
+        // Must be called before the first Get(), 0 = hardware concurrency
+        static void SetDefaultThreadCount(unsigned int threadCount);
+        // Must be called before the first Get(), see NumaTopology for cpu lists
+        static void SetDefaultCpus(const std::vector<unsigned int>& cpus);
+
+        // Uniform cost per index, chunks of at most grainSize indices
+        void ParallelFor(size_t begin, size_t end, size_t grainSize, const RangeFunction& body);
+        void ParallelFor(size_t begin, size_t end, const RangeFunction& body);
+
+        // Chunks hold roughly equal summed cost instead of equal index counts
+        void ParallelForWeighted(const std::vector<uint32_t>& costs, const RangeFunction& body);
+
+        unsigned int GetThreadCount() const noexcept;
+        bool IsPinned() const noexcept;
+
+    private:
+        struct Job {
+            const RangeFunction* body;
+            std::atomic<size_t> remaining;
+
+            // First exception of any body, later chunks are skipped
+            std::atomic<bool> failed = false;
+            std::exception_ptr error = nullptr;
+        };
+
+        struct Chunk {
+            size_t begin;
+            size_t end;
+            Job*   job;
+        };
+
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Chunk> chunks;
+        };
+
+        void Run(Job& job, const std::vector<Chunk>& chunks);
+
+        void WorkerLoop(unsigned int workerIndex, int cpu);
+        bool TryPop(unsigned int workerIndex, Chunk& chunk);
+        bool TrySteal(unsigned int workerIndex, Chunk& chunk);
+        void Execute(const Chunk& chunk);
+
+    private:
+        // How many chunks each thread gets on average, more = better balance, more overhead
+        static constexpr size_t CHUNKS_PER_THREAD = 8;
+
+        std::vector<std::unique_ptr<WorkerQueue>> mQueues; // Index 0 belongs to the calling thread
+        std::vector<std::thread> mThreads;
+        std::vector<std::vector<unsigned int>> mStealOrder; // Victims per worker, same node first
+        bool mPinned = false;
+
+        std::mutex mSleepMutex;
+        std::condition_variable mWakeUp;
+        std::condition_variable mJobDone;
+        std::atomic<size_t> mPendingChunks = 0;
+
+        std::mutex mRunMutex; // One parallel loop at a time
+        bool mStop = false;
+};
+
+}
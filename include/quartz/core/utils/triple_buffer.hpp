@@ -0,0 +1,50 @@
+#pragma once
+// C++ standard libraries
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace quartz {
+
+// Single producer, single consumer. The producer never waits for the consumer and
+// the consumer always gets the most recently published buffer
+template<typename T>
+class TripleBuffer {
+    public:
+        // Producer side
+        T& GetWriteBuffer() noexcept {
+            return mBuffers[mWriteIndex];
+        }
+
+        void Publish() noexcept {
+            uint8_t previous = mMiddle.exchange(mWriteIndex | FRESH_BIT, std::memory_order_acq_rel);
+            mWriteIndex = previous & INDEX_MASK;
+        }
+
+        // Consumer side, returns false when nothing new was published since the last call
+        bool Consume() noexcept {
+            if(!(mMiddle.load(std::memory_order_acquire) & FRESH_BIT)) {
+                return false;
+            }
+
+            uint8_t previous = mMiddle.exchange(mReadIndex, std::memory_order_acq_rel);
+            mReadIndex = previous & INDEX_MASK;
+            return true;
+        }
+
+        const T& GetReadBuffer() const noexcept {
+            return mBuffers[mReadIndex];
+        }
+
+    private:
+        static constexpr uint8_t INDEX_MASK = 0b011;
+        static constexpr uint8_t FRESH_BIT  = 0b100;
+
+        std::array<T, 3> mBuffers;
+
+        uint8_t mWriteIndex = 0;
+        std::atomic<uint8_t> mMiddle = 1;
+        uint8_t mReadIndex = 2;
+};
+
+}
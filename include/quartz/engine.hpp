@@ -5,6 +5,11 @@
 #include <fstream>
 #include <iostream>
 #include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 // Third_party libraries
 #include <SDL3/SDL.h>
@@ -30,6 +35,21 @@ class Engine {
         void SetEventCallback(const std::function<void(float)>& func);
         void SetUpdateCallback(const std::function<void(float)>& func);
         void SetSystemCallback(const std::function<void(float)>& func);
+        void SetFixedUpdateCallback(const std::function<void(float)>& func);
+
+        // fixedStep <= 0 runs the fixed update once per frame with the frame time
+        void SetFixedTimeStep(float fixedStep, int maxSubsteps);
+
+        // How far the render frame is between the last two fixed updates [0, 1)
+        float GetInterpolationAlpha() const;
+
+        // Fixed updates run on a worker thread, the callback must not touch gl
+        void SetThreadedSimulation(bool threaded);
+        bool IsSimulationThreaded() const;
+    private:
+        void RunFixedUpdates(float deltaTime);
+        void SimulationLoop();
+
     private:
         SDL_Window* mWindow = nullptr;
         SDL_GLContext mOpenGLContext;
@@ -37,13 +57,23 @@ class Engine {
         std::function<void(float)> mEventCallback;
         std::function<void(float)> mUpdateCallback;
         std::function<void(float)> mSystemCallback;
+        std::function<void(float)> mFixedUpdateCallback;
 
         int mScreenWidth;
         int mScreenHeight;
 
         Uint64 mLastTime = 0;
 
-        bool mQuit = false;
+        // Fixed timestep
+        float mFixedStep   = 0.0f;
+        int   mMaxSubsteps = 1;
+        float mAccumulator = 0.0f;
+        float mInterpolationAlpha = 1.0f;
+
+        bool mThreadedSimulation = false;
+        std::thread mSimulationThread;
+
+        std::atomic<bool> mQuit = false;
 };
 
 }
\ No newline at end of file
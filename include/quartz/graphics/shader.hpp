@@ -3,6 +3,8 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <utility>
+#include <vector>
 
 // Third_party libraries
 #include <glad/glad.h>
@@ -10,9 +12,22 @@
 namespace shader {
 
     GLuint CompileShader(GLuint type, const std::string& shaderPath);
+    // Inserts prelude right after the #version line
+    GLuint CompileShader(GLuint type, const std::string& shaderPath, const std::string& prelude);
     GLuint LinkProgram(GLuint& shader);
 
     GLuint CreateGraphicsPipeline(const std::string& _vertexShaderSource, const std::string& _fragmentShaderSource);
+    // Name, value pairs written as #define lines after #version, ahead of any prelude
+    using Defines = std::vector<std::pair<std::string, std::string>>;
+
+    // Compiles and links a compute program, both creators go through the program cache.
+    // Sources may #include "file" relative to themselves.
+    GLuint CreateComputeProgram(const std::string& shaderPath, const Defines& defines = {}, const std::string& prelude = "");
+    // Float constant that GLSL reads as a float
+    std::string FloatLiteral(float value);
+
+    // Linked programs are stored here keyed by their sources and the driver, empty disables the cache
+    void SetProgramCacheDirectory(const std::string& directory);
 
     int FindUniformLocation(GLuint pipeline, const GLchar* name);
 
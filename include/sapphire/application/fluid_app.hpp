@@ -2,6 +2,8 @@
 // C++ standard libraries
 #include <string>
 #include <format>
+#include <memory>
+#include <vector>
 
 // Third_party libraries
 #include <glm/glm.hpp>
@@ -11,6 +13,7 @@
 #include "bismuth/registry.hpp"
 #include "sapphire/utility/window_data.hpp"
 #include "sapphire/utility/data_buffers.hpp"
+#include "sapphire/utility/simulation_parameters.hpp"
 
 #include "quartz/core/systems/camera_system.hpp"
 #include "quartz/ui/systems/gui_camera_system.hpp"
@@ -21,6 +24,8 @@
 // #include "quartz/graphics/instanced_renderer_system.hpp"
 #include "sapphire/systems/gpu_sphere_data_system.hpp"
 #include "sapphire/systems/particle_system.hpp"
+#include "sapphire/systems/snapshot_render_system.hpp"
+#include "sapphire/simulation/cpu_simulation.hpp"
 
 #include "quartz/ui/components/gui_mesh.hpp"
 #include "quartz/ui/components/gui_object_component.hpp"
@@ -37,6 +42,7 @@
 #include "sapphire/components/velocity_component.hpp"
 #include "sapphire/components/energy_component.hpp"
 #include "sapphire/components/particle_settings.hpp"
+#include "sapphire/components/time_step_component.hpp"
 
 class FluidApp {
     public:
@@ -49,11 +55,16 @@ class FluidApp {
         void Loop(float deltaTime);
         void System(float deltaTime);
         void Event(float deltaTime);
+        void FixedUpdate(float deltaTime);
 
         void SpawnParticles(int mouseX, int mouseY);
+        void CreateParticle(float x, float y, float z, float mass, glm::vec4 velocity);
 
         // Main helpers
         void FpsCounter(float deltaTime);
+        void UpdateProfilerOverlay();
+        // Reads gpu state back without stalling, the registry follows the gpu once a copy lands
+        void UpdateDiagnostics();
         void InitEntities();
         
         void InitInterface();
@@ -63,7 +74,8 @@ class FluidApp {
             glm::vec4   const& bgColor,
             glm::vec4   const& fontColor,
             float              fontSize,
-            float            & valueRef
+            float            & valueRef,
+            float              step = 1.0f
         );
         
     private:
@@ -78,4 +90,20 @@ class FluidApp {
         DataBuffers mDataBuffers;
         ParticleSystem mParticleSystem;
 
+        // Needs a gl context, created after the engine is initialized
+        std::unique_ptr<GPUSphereDataSystem> mGPUSphereDataSystem;
+
+        // Threaded mode, cpu pipeline on the engine's simulation thread
+        CpuSimulation mCpuSimulation;
+        std::unique_ptr<SnapshotRenderSystem> mSnapshotRenderer;
+
+        // One text row per profiled gpu pass
+        std::vector<bismuth::EntityID> mProfilerLabels;
+        uint32_t mOverlayFrame = 0;
+
+        // From the last landed gpu readback
+        uint32_t mDiagnosticsFrame = 0;
+        float mKineticEnergy = 0.0f;
+        float mMaxSpeed = 0.0f;
+
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+// C++ standard libraries
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "sapphire/utility/scene.hpp"
+#include "sapphire/utility/particle_pools.hpp"
+#include "sapphire/simulation/cpu_simulation.hpp"
+#include "sapphire/distributed/transport.hpp"
+
+// Runs the cpu pipeline without a window or gl context
+class HeadlessApp {
+    public:
+        // With a transport of more than one rank every process simulates its part of the scene
+        HeadlessApp(const std::string& scenePath, std::shared_ptr<ITransport> transport = nullptr);
+
+        void Run();
+
+        // Command line overrides
+        void SetSteps(int steps);
+        void SetOutputDirectory(const std::string& outputDirectory);
+
+    private:
+        void InitEntities();
+        void WriteSnapshot(int step);
+        // Per rank file name when the scene is split across processes
+        std::string RankFileName(const std::string& stem, const std::string& extension) const;
+
+    private:
+        Scene mScene;
+        CpuSimulation mSimulation;
+};
@@ -0,0 +1,10 @@
+#pragma once
+// C++ standard libraries
+#include <cstdint>
+
+// Dormancy state, dormant particles are skipped by SphereDataSystem until a lively neighbor wakes them
+struct ActivityComponent {
+    uint32_t calmSteps = 0;
+    uint32_t dormant   = 0;
+    uint32_t wake      = 0; // Written by neighbors on other threads, only through std::atomic_ref
+};
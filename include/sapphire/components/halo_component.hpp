@@ -0,0 +1,5 @@
+#pragma once
+
+// Read-only copy of a particle owned by another process, dropped at the end of the step
+struct HaloComponent {
+};
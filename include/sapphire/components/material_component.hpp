@@ -0,0 +1,7 @@
+#pragma once
+// Own libraries
+#include "sapphire/eos/material_type.hpp"
+
+struct MaterialComponent {
+    MaterialType material;
+};
@@ -0,0 +1,8 @@
+#pragma once
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Authoritative position with DOUBLE_PRECISION_POSITIONS, SphereComponent then holds the rounded copy
+struct PrecisePositionComponent {
+    glm::dvec3 position;
+};
@@ -0,0 +1,21 @@
+#pragma once
+// Own libraries
+#include "sapphire/utility/config.hpp"
+
+// Simulation constants that can change at runtime, defaults come from sapphire_config
+struct SimulationParametersComponent {
+    float smoothingLength = sapphire_config::SMOOTHING_LENGTH; // Baked into the kernels, read once at startup
+    float g               = sapphire_config::G;
+    float energy          = sapphire_config::INITIAL_ENERGY;
+
+    // Integration
+    float timeStep        = sapphire_config::TIME_STEP; // Used when the time step is not adaptive
+    float viscosity       = sapphire_config::VISCOSITY;
+    float cflFactor       = sapphire_config::CFL_FACTOR;
+    float forceFactor     = sapphire_config::FORCE_FACTOR;
+    float viscosityFactor = sapphire_config::VISCOSITY_FACTOR;
+    float minTimeStep     = sapphire_config::MIN_TIME_STEP;
+    float maxTimeStep     = sapphire_config::MAX_TIME_STEP;
+
+    bool operator==(const SimulationParametersComponent&) const = default;
+};
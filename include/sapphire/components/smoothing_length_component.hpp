@@ -0,0 +1,6 @@
+#pragma once
+
+// Kernel smoothing length h, the support radius is h times the kernel's support
+struct SmoothingLengthComponent {
+    float h;
+};
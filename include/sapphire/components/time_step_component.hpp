@@ -0,0 +1,8 @@
+#pragma once
+// Own libraries
+#include "sapphire/utility/config.hpp"
+
+struct TimeStepComponent {
+    float  dt   = sapphire_config::TIME_STEP;
+    double time = 0.0; // Simulated time
+};
@@ -0,0 +1,17 @@
+#pragma once
+// C++ standard libraries
+#include <cstddef>
+#include <vector>
+
+// Moves byte messages between the processes of one run, ranks are 0..size-1
+class ITransport {
+    public:
+        virtual ~ITransport() = default;
+
+        virtual int GetRank() const = 0;
+        virtual int GetSize() const = 0;
+
+        // Sends outgoing[r] to rank r and returns what every rank sent to this one.
+        // Collective, every rank has to call it the same number of times
+        virtual std::vector<std::vector<std::byte>> Exchange(const std::vector<std::vector<std::byte>>& outgoing) = 0;
+};
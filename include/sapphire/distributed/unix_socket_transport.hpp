@@ -0,0 +1,35 @@
+#pragma once
+// C++ standard libraries
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Third_party libraries
+#include <sys/types.h>
+
+// Own libraries
+#include "sapphire/distributed/transport.hpp"
+
+// Single machine transport, one Unix socket pair between every two processes
+class UnixSocketTransport : public ITransport {
+    public:
+        // Forks processCount - 1 children, every process returns with its own rank.
+        // Must run before any thread is started
+        static std::unique_ptr<UnixSocketTransport> Launch(int processCount);
+
+        ~UnixSocketTransport() override;
+
+        int GetRank() const override;
+        int GetSize() const override;
+
+        std::vector<std::vector<std::byte>> Exchange(const std::vector<std::vector<std::byte>>& outgoing) override;
+
+    private:
+        UnixSocketTransport(int rank, std::vector<int> sockets, std::vector<pid_t> children);
+
+    private:
+        int mRank;
+        std::vector<int> mSockets; // Per peer rank, -1 for this rank
+        std::vector<pid_t> mChildren; // Only rank 0 waits for them
+};
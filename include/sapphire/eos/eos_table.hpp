@@ -0,0 +1,70 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "sapphire/eos/equation_of_state.hpp"
+#include "sapphire/eos/material_type.hpp"
+#include "sapphire/utility/config.hpp"
+
+namespace sapphire {
+    struct EosSample {
+        float pressure;
+        float soundSpeed;
+    };
+
+    // Pressure and sound speed sampled on a regular (density, energy) grid.
+    // Lookups interpolate bilinearly without branches, outside the grid the edge cells extrapolate linearly
+    class EosTable {
+        public:
+            EosTable(
+                MaterialType material,
+                uint32_t densitySamples = sapphire_config::EOS_DENSITY_SAMPLES,
+                uint32_t energySamples  = sapphire_config::EOS_ENERGY_SAMPLES
+            );
+
+            EosSample Evaluate(float density, float energy) const {
+                const float x = (density - mOrigin.x) * mInverseStep.x;
+                const float y = (energy  - mOrigin.y) * mInverseStep.y;
+
+                const int i = std::clamp(static_cast<int>(std::floor(x)), 0, static_cast<int>(mSize.x) - 2);
+                const int j = std::clamp(static_cast<int>(std::floor(y)), 0, static_cast<int>(mSize.y) - 2);
+                const float tx = x - i;
+                const float ty = y - j;
+
+                const glm::vec2* row = mSamples.data() + static_cast<size_t>(j) * mSize.x + i;
+                const glm::vec2 low  = row[0]       + tx * (row[1]           - row[0]);
+                const glm::vec2 high = row[mSize.x] + tx * (row[mSize.x + 1] - row[mSize.x]);
+                const glm::vec2 sample = low + ty * (high - low);
+
+                return {sample.x, std::max(sample.y, 0.0f)};
+            }
+
+            // Row major with density along a row, x = pressure, y = sound speed
+            const std::vector<glm::vec2>& GetSamples() const { return mSamples; }
+            glm::uvec2 GetSize() const { return mSize; }
+            glm::vec2 GetOrigin() const { return mOrigin; }
+            glm::vec2 GetInverseStep() const { return mInverseStep; }
+
+            // Sound speed at rest density and INITIAL_ENERGY
+            float GetReferenceSoundSpeed() const { return mReferenceSoundSpeed; }
+
+        private:
+            glm::uvec2 mSize;
+            glm::vec2 mOrigin;
+            glm::vec2 mInverseStep;
+            float mReferenceSoundSpeed;
+
+            std::vector<glm::vec2> mSamples;
+    };
+
+    // Built once on first use and shared by every system
+    const EosTable& GetEosTable(MaterialType material);
+}
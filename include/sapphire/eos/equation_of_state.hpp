@@ -0,0 +1,30 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Own libraries
+#include "sapphire/eos/material_type.hpp"
+#include "sapphire/utility/config.hpp"
+
+namespace sapphire {
+    // Tillotson (1962) parameters as used by Benz & Asphaug (1999), SI units
+    struct TillotsonParameters {
+        double restDensity;
+        double A, B;                  // Bulk modulus and nonlinear compression term
+        double E0;                    // Reference energy
+        double Es, EsPrime;           // Incipient and complete vaporization energies
+        double a, b, alpha, beta;
+    };
+
+    TillotsonParameters GetTillotsonParameters(MaterialType material);
+    double TillotsonPressure(const TillotsonParameters& parameters, double density, double energy);
+
+    // Analytic laws, too slow for the step itself, they only fill the EosTable
+    double Pressure(MaterialType material, double density, double energy);
+    // c^2 = dp/drho + p/rho^2 dp/de, by central differences
+    double SoundSpeed(MaterialType material, double density, double energy);
+
+    double RestDensity(MaterialType material);
+}
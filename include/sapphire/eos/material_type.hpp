@@ -0,0 +1,12 @@
+#pragma once
+// C++ standard libraries
+#include <cstddef>
+
+enum class MaterialType {
+    Fluid,   // Linear law p = k(rho - rho0) in simulation units
+    Basalt,  // Tillotson, SI units
+    Granite, // Tillotson, SI units
+    Iron     // Tillotson, SI units
+};
+
+constexpr size_t MATERIAL_COUNT = 4;
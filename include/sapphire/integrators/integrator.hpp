@@ -0,0 +1,20 @@
+#pragma once
+// C++ standard libraries
+#include <memory>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/core/utils/task_pool.hpp"
+#include "sapphire/integrators/integrator_type.hpp"
+
+// A time step is split around the force computation:
+// Predict() runs on the forces of the previous step, Correct() on the freshly computed ones
+class IIntegrator {
+    public:
+        virtual ~IIntegrator() = default;
+
+        virtual void Predict(bismuth::Registry& registry, float deltaTime) = 0;
+        virtual void Correct(bismuth::Registry& registry, float deltaTime) = 0;
+};
+
+std::unique_ptr<IIntegrator> CreateIntegrator(IntegratorType type);
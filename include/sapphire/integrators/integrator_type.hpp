@@ -0,0 +1,7 @@
+#pragma once
+
+enum class IntegratorType {
+    SymplecticEuler, // Kick then drift with the full step
+    Leapfrog,        // Kick-drift-kick
+    VelocityVerlet   // Position form with averaged accelerations
+};
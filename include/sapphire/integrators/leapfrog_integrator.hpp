@@ -0,0 +1,14 @@
+#pragma once
+// Own libraries
+#include "sapphire/integrators/integrator.hpp"
+#include "sapphire/components/force_component.hpp"
+#include "sapphire/components/velocity_component.hpp"
+#include "sapphire/components/mass_component.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+#include "sapphire/utility/position_view.hpp"
+
+class LeapfrogIntegrator : public IIntegrator {
+    public:
+        void Predict(bismuth::Registry& registry, float deltaTime) override;
+        void Correct(bismuth::Registry& registry, float deltaTime) override;
+};
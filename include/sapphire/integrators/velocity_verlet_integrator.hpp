@@ -0,0 +1,24 @@
+#pragma once
+// C++ standard libraries
+#include <vector>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "sapphire/integrators/integrator.hpp"
+#include "sapphire/components/force_component.hpp"
+#include "sapphire/components/velocity_component.hpp"
+#include "sapphire/components/mass_component.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+#include "sapphire/utility/position_view.hpp"
+
+class VelocityVerletIntegrator : public IIntegrator {
+    public:
+        void Predict(bismuth::Registry& registry, float deltaTime) override;
+        void Correct(bismuth::Registry& registry, float deltaTime) override;
+
+    private:
+        // Acceleration at the start of the step, indexed like the sphere dense array
+        std::vector<glm::vec4> mPreviousAcceleration;
+};
@@ -0,0 +1,12 @@
+#pragma once
+// C++ standard libraries
+#include <string>
+
+// Own libraries
+#include "sapphire/kernels/kernels.hpp"
+
+namespace sapphire {
+    // GLSL for KernelW, KernelDerivative, KernelGradient and KernelLaplacian of one kernel,
+    // generated from the same tables as the cpu kernels with h and normalization folded in
+    std::string GenerateKernelGLSL(KernelType type, float supportRadius);
+}
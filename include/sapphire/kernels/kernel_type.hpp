@@ -0,0 +1,8 @@
+#pragma once
+
+enum class KernelType {
+    CubicSpline, // M4 B-spline, support 2h
+    WendlandC2,  // Support 2h
+    WendlandC4,  // Support 2h, resists pairing with many neighbors
+    Quintic      // M6 B-spline, support 3h
+};
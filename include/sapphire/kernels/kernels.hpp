@@ -0,0 +1,163 @@
+#pragma once
+// C++ standard libraries
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "sapphire/kernels/kernel_type.hpp"
+#include "sapphire/kernels/polynomial.hpp"
+#include "sapphire/utility/utility.hpp"
+
+namespace sapphire {
+
+// One polynomial piece of a kernel shape, valid for q < end
+struct KernelPiece {
+    float end;
+    Polynomial shape;
+};
+
+// Kernel policies: 3D shape f(q) on q = r/h with W(r, h) = NORMALIZATION / h^3 * f(q)
+struct CubicSplinePolicy {
+    static constexpr const char* NAME = "CubicSpline";
+    static constexpr float SUPPORT = 2.0f;
+    static constexpr float NORMALIZATION = 1.0f / PI;
+    static constexpr std::array<KernelPiece, 2> PIECES = {{
+        {1.0f, Polynomial{1.0, 0.0, -1.5, 0.75}},
+        {2.0f, Power(2.0, -1.0, 3) * 0.25}
+    }};
+};
+
+struct WendlandC2Policy {
+    static constexpr const char* NAME = "WendlandC2";
+    static constexpr float SUPPORT = 2.0f;
+    static constexpr float NORMALIZATION = 21.0f / (16.0f * PI);
+    static constexpr std::array<KernelPiece, 1> PIECES = {{
+        {2.0f, Power(1.0, -0.5, 4) * Polynomial{1.0, 2.0}}
+    }};
+};
+
+struct WendlandC4Policy {
+    static constexpr const char* NAME = "WendlandC4";
+    static constexpr float SUPPORT = 2.0f;
+    static constexpr float NORMALIZATION = 495.0f / (256.0f * PI);
+    static constexpr std::array<KernelPiece, 1> PIECES = {{
+        {2.0f, Power(1.0, -0.5, 6) * Polynomial{1.0, 3.0, 35.0 / 12.0}}
+    }};
+};
+
+struct QuinticPolicy {
+    static constexpr const char* NAME = "Quintic";
+    static constexpr float SUPPORT = 3.0f;
+    static constexpr float NORMALIZATION = 1.0f / (120.0f * PI);
+    static constexpr std::array<KernelPiece, 3> PIECES = {{
+        {1.0f, Power(3.0, -1.0, 5) + Power(2.0, -1.0, 5) * -6.0 + Power(1.0, -1.0, 5) * 15.0},
+        {2.0f, Power(3.0, -1.0, 5) + Power(2.0, -1.0, 5) * -6.0},
+        {3.0f, Power(3.0, -1.0, 5)}
+    }};
+};
+
+// Pieces stored around their end, in u = end - q, so compact support ends in an exact zero
+template<size_t N>
+constexpr std::array<KernelPiece, N> ReflectPieces(const std::array<KernelPiece, N>& pieces) {
+    std::array<KernelPiece, N> result{};
+    for(size_t i = 0; i < N; i++) {
+        result[i] = {pieces[i].end, Reflect(pieces[i].shape, pieces[i].end)};
+    }
+    return result;
+}
+
+// d/dq of reflected pieces, dq = -du
+template<size_t N>
+constexpr std::array<KernelPiece, N> DerivativePieces(const std::array<KernelPiece, N>& pieces) {
+    std::array<KernelPiece, N> result{};
+    for(size_t i = 0; i < N; i++) {
+        result[i] = {pieces[i].end, pieces[i].shape.Derivative() * -1.0};
+    }
+    return result;
+}
+
+template<size_t N>
+constexpr float EvaluatePieces(const std::array<KernelPiece, N>& pieces, float q) {
+    for(size_t i = 0; i < N; i++) {
+        if(q < pieces[i].end) {
+            return pieces[i].shape.Evaluate(pieces[i].end - q);
+        }
+    }
+    return 0.0f;
+}
+
+// Everything but the smoothing length is known at compile time
+template<typename Policy>
+struct Kernel {
+    static constexpr float SUPPORT = Policy::SUPPORT;
+    static constexpr auto PIECES            = ReflectPieces(Policy::PIECES);
+    static constexpr auto DERIVATIVE_PIECES = DerivativePieces(PIECES);
+
+    static float W(float radius, float smoothingLength) {
+        const float invH = 1.0f / smoothingLength;
+        return Policy::NORMALIZATION * invH*invH*invH * EvaluatePieces(PIECES, radius * invH);
+    }
+
+    // dW/dr
+    static float Derivative(float radius, float smoothingLength) {
+        const float invH = 1.0f / smoothingLength;
+        return Policy::NORMALIZATION * invH*invH*invH*invH * EvaluatePieces(DERIVATIVE_PIECES, radius * invH);
+    }
+
+    static glm::vec3 Gradient(const glm::vec3& deltaPoint, float radius, float smoothingLength) {
+        if(radius == 0.0f) {
+            return glm::vec3(0.0f);
+        }
+        return Derivative(radius, smoothingLength) * (deltaPoint / radius);
+    }
+
+    // dW/dh at fixed r, for the smoothing length iteration
+    static float DerivativeH(float radius, float smoothingLength) {
+        const float invH = 1.0f / smoothingLength;
+        const float q = radius * invH;
+        return -Policy::NORMALIZATION * invH*invH*invH*invH *
+            (3.0f * EvaluatePieces(PIECES, q) + q * EvaluatePieces(DERIVATIVE_PIECES, q));
+    }
+
+    // -2/r dW/dr, a positive Laplacian estimate that keeps the viscosity term dissipative
+    static float Laplacian(float radius, float smoothingLength) {
+        if(radius == 0.0f) {
+            return 0.0f;
+        }
+        return -2.0f * Derivative(radius, smoothingLength) / radius;
+    }
+};
+
+using CubicSplineKernel = Kernel<CubicSplinePolicy>;
+using WendlandC2Kernel  = Kernel<WendlandC2Policy>;
+using WendlandC4Kernel  = Kernel<WendlandC4Policy>;
+using QuinticKernel     = Kernel<QuinticPolicy>;
+
+// Calls body with a default constructed Kernel<Policy> matching type
+template<typename Body>
+decltype(auto) DispatchKernel(KernelType type, Body&& body) {
+    switch(type) {
+        case KernelType::WendlandC2:
+            return body(WendlandC2Kernel{});
+        case KernelType::WendlandC4:
+            return body(WendlandC4Kernel{});
+        case KernelType::Quintic:
+            return body(QuinticKernel{});
+        case KernelType::CubicSpline:
+        default:
+            return body(CubicSplineKernel{});
+    }
+}
+
+// Support radius in units of h
+inline float KernelSupport(KernelType type) {
+    return DispatchKernel(type, [](auto kernel) {
+        return decltype(kernel)::SUPPORT;
+    });
+}
+
+}
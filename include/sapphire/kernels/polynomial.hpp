@@ -0,0 +1,104 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+
+namespace sapphire {
+
+// Dense polynomial in q, built at compile time for the kernel tables
+struct Polynomial {
+    static constexpr size_t MAX_COEFFICIENTS = 10;
+
+    // coefficients[i] * q^i, double so the compile time expansion does not lose digits
+    std::array<double, MAX_COEFFICIENTS> coefficients{};
+
+    constexpr Polynomial() = default;
+    constexpr Polynomial(std::initializer_list<double> values) {
+        size_t i = 0;
+        for(double value : values) {
+            coefficients[i++] = value;
+        }
+    }
+
+    constexpr size_t Size() const {
+        size_t size = MAX_COEFFICIENTS;
+        while(size > 0 && coefficients[size-1] == 0.0f) {
+            size--;
+        }
+        return size;
+    }
+
+    constexpr float Evaluate(float q) const {
+        float result = 0.0f;
+        for(size_t i = MAX_COEFFICIENTS; i > 0; i--) {
+            result = result * q + static_cast<float>(coefficients[i-1]);
+        }
+        return result;
+    }
+
+    constexpr Polynomial Derivative() const {
+        Polynomial result;
+        for(size_t i = 1; i < MAX_COEFFICIENTS; i++) {
+            result.coefficients[i-1] = coefficients[i] * static_cast<double>(i);
+        }
+        return result;
+    }
+
+    constexpr Polynomial operator+(const Polynomial& other) const {
+        Polynomial result;
+        for(size_t i = 0; i < MAX_COEFFICIENTS; i++) {
+            result.coefficients[i] = coefficients[i] + other.coefficients[i];
+        }
+        return result;
+    }
+
+    constexpr Polynomial operator*(const Polynomial& other) const {
+        Polynomial result;
+        for(size_t i = 0; i < MAX_COEFFICIENTS; i++) {
+            for(size_t j = 0; i + j < MAX_COEFFICIENTS; j++) {
+                result.coefficients[i+j] += coefficients[i] * other.coefficients[j];
+            }
+        }
+        return result;
+    }
+
+    constexpr Polynomial operator*(double scale) const {
+        Polynomial result;
+        for(size_t i = 0; i < MAX_COEFFICIENTS; i++) {
+            result.coefficients[i] = coefficients[i] * scale;
+        }
+        return result;
+    }
+};
+
+// (a + b*q)^n
+constexpr Polynomial Power(double a, double b, unsigned n) {
+    Polynomial result{1.0};
+    for(unsigned i = 0; i < n; i++) {
+        result = result * Polynomial{a, b};
+    }
+    return result;
+}
+
+// Rewrites p(q) as r(u) = p(origin - u), small terms near origin keep float evaluation exact there
+constexpr Polynomial Reflect(const Polynomial& polynomial, double origin) {
+    Polynomial result;
+    double largest = 0.0;
+    for(size_t i = 0; i < Polynomial::MAX_COEFFICIENTS; i++) {
+        result = result + Power(origin, -1.0, i) * polynomial.coefficients[i];
+    }
+    for(double coefficient : result.coefficients) {
+        largest = std::max(largest, coefficient < 0.0 ? -coefficient : coefficient);
+    }
+    // Terms that cancel out exactly come back as rounding noise
+    for(double& coefficient : result.coefficients) {
+        if((coefficient < 0.0 ? -coefficient : coefficient) < 1e-12 * largest) {
+            coefficient = 0.0;
+        }
+    }
+    return result;
+}
+
+}
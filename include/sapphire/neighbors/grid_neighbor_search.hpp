@@ -0,0 +1,31 @@
+#pragma once
+// C++ standard libraries
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "sapphire/neighbors/neighbor_search.hpp"
+#include "sapphire/systems/pos_to_spatial_system.hpp"
+#include "sapphire/utility/config.hpp"
+#include "sapphire/utility/utility.hpp"
+#include "sapphire/components/position_component.hpp"
+#include "sapphire/components/spatial_hash_component.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+
+// Chunks of SPATIAL_LENGTH^3 cells, each cell SMOOTHING_LENGTH wide
+class GridNeighborSearch : public INeighborSearch {
+    public:
+        void Build(bismuth::Registry& registry) override;
+        void Query(size_t entityID, float radius, std::vector<size_t>& neighbors) const override;
+
+    private:
+        static void CheckNeighbor(int currentChunk, int& chunkNeighbor, int& neighbor);
+
+    private:
+        PosToSpatialSystem mPosToSpatialSystem;
+        bismuth::Registry* mRegistry = nullptr;
+};
@@ -0,0 +1,70 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "sapphire/neighbors/neighbor_search.hpp"
+#include "sapphire/utility/config.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+
+// Median split k-d tree over the particle positions. Between full rebuilds the topology
+// is kept and only the bounds are refit, until the tree got too loose or too many refits passed
+class KdTreeNeighborSearch : public INeighborSearch {
+    public:
+        void Build(bismuth::Registry& registry) override;
+        void Query(size_t entityID, float radius, std::vector<size_t>& neighbors) const override;
+
+        // Consecutive queries share one traversal, dense order is spatially coherent after a reorder
+        void QueryBatch(
+            std::vector<uint32_t>            const& entityIDs,
+            std::vector<float>               const& radii,
+            std::vector<uint32_t>            const& costs,
+            std::vector<std::vector<size_t>>&       neighbors
+        ) const override;
+
+    private:
+        // Pre-order layout, the left child directly follows its parent
+        struct Node {
+            glm::vec3 boundsMin;
+            uint32_t  begin;
+            glm::vec3 boundsMax;
+            uint32_t  end;
+            uint32_t  right = 0; // 0 for leaves
+        };
+
+        void Rebuild(bismuth::Registry& registry);
+        // False if the particle set changed and a rebuild is needed
+        bool Refit(bismuth::Registry& registry);
+
+        static uint32_t CountNodes(uint32_t count);
+        void BuildNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, std::vector<glm::vec3> const& positions);
+        // Partitions mOrder around the median of the widest axis, returns the split index
+        uint32_t SplitNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, std::vector<glm::vec3> const& positions);
+        // Bounds from mPoints, leaves in parallel then inner nodes bottom up
+        void Fit();
+
+        float LeafSurfaceArea() const;
+
+        // Leaves whose bounds come within radius of the box
+        void CollectLeaves(glm::vec3 const& boundsMin, glm::vec3 const& boundsMax, float radius, std::vector<uint32_t>& leaves) const;
+        void QueryLeaf(Node const& leaf, glm::vec3 const& point, float radiusSquared, std::vector<size_t>& neighbors) const;
+
+    private:
+        std::vector<Node>      mNodes;
+        std::vector<uint32_t>  mLeaves;
+        std::vector<uint32_t>  mOrder;     // Build order of dense indices
+        std::vector<glm::vec3> mPoints;    // Positions in tree order
+        std::vector<size_t>    mEntityIDs; // Entities in tree order
+        std::vector<uint32_t>  mSlots;     // Entity ID to tree order
+
+        uint32_t mRefits = 0;
+        float mBuildSurfaceArea = 0.0f;
+};
@@ -0,0 +1,32 @@
+#pragma once
+// C++ standard libraries
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/core/utils/task_pool.hpp"
+#include "sapphire/neighbors/neighbor_search_type.hpp"
+
+// Radius queries around particles. Build() runs once per step after the positions moved,
+// queries until the next Build() see the positions of that step
+class INeighborSearch {
+    public:
+        virtual ~INeighborSearch() = default;
+
+        virtual void Build(bismuth::Registry& registry) = 0;
+
+        // Entity IDs within radius of the particle, the particle itself included
+        virtual void Query(size_t entityID, float radius, std::vector<size_t>& neighbors) const = 0;
+
+        // neighbors[i] receives the query around entityIDs[i], costs weight the parallel split
+        virtual void QueryBatch(
+            std::vector<uint32_t>            const& entityIDs,
+            std::vector<float>               const& radii,
+            std::vector<uint32_t>            const& costs,
+            std::vector<std::vector<size_t>>&       neighbors
+        ) const;
+};
+
+std::unique_ptr<INeighborSearch> CreateNeighborSearch(NeighborSearchType type);
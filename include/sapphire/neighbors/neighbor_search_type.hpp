@@ -0,0 +1,6 @@
+#pragma once
+
+enum class NeighborSearchType {
+    Grid,  // Uniform chunked cells, cheap when the density is roughly uniform
+    KdTree // Median split tree, for density contrasts of several orders of magnitude
+};
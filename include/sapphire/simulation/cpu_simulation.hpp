@@ -0,0 +1,80 @@
+#pragma once
+// C++ standard libraries
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/core/utils/triple_buffer.hpp"
+#include "sapphire/systems/particle_system.hpp"
+#include "sapphire/systems/sphere_data_system.hpp"
+#include "sapphire/systems/force_to_pos_system.hpp"
+#include "sapphire/systems/time_step_system.hpp"
+#include "sapphire/systems/morton_reorder_system.hpp"
+#include "sapphire/systems/domain_culling_system.hpp"
+#include "sapphire/systems/domain_decomposition_system.hpp"
+#include "sapphire/components/time_step_component.hpp"
+
+// Render data handed from the simulation thread to the render thread
+struct ParticleSnapshot {
+    std::vector<glm::vec4> positionAndRadius;
+    double time = 0.0;
+};
+
+struct SpawnRequest {
+    glm::vec3 position;
+    float     mass;
+    glm::vec4 velocity;
+};
+
+// Owns its own registry so it can be stepped on a different thread than the gui registry
+class CpuSimulation {
+    public:
+        CpuSimulation(
+            bool reorder = sapphire_config::MORTON_REORDER,
+            NeighborSearchType neighborSearch = sapphire_config::NEIGHBOR_SEARCH
+        );
+
+        // Simulation thread
+        void Step();
+        void PublishSnapshot();
+
+        // Any thread, applied at the start of the next step
+        void QueueParticle(const glm::vec3& position, float mass, const glm::vec4& velocity);
+
+        quartz::TripleBuffer<ParticleSnapshot>& GetSnapshots();
+        bismuth::Registry& GetRegistry();
+        ParticleSystem& GetParticleSystem();
+        DomainCullingSystem& GetDomainCullingSystem();
+
+        // Splits the particles across the ranks of transport, before the first step
+        void EnableDecomposition(std::shared_ptr<ITransport> transport);
+        // Null when running as a single process
+        DomainDecompositionSystem* GetDecompositionSystem() const;
+
+    private:
+        void FlushSpawnQueue();
+
+    private:
+        bismuth::Registry mRegistry;
+        ParticleSystem mParticleSystem;
+
+        TimeStepSystem mTimeStepSystem;
+        SphereDataSystem mSphereDataSystem;
+        ForceToPosSystem mForceToPosSystem;
+        MortonReorderSystem mReorderSystem;
+        DomainCullingSystem mDomainCullingSystem;
+        std::unique_ptr<DomainDecompositionSystem> mDecompositionSystem;
+
+        bool mReorder;
+
+        std::mutex mSpawnMutex;
+        std::vector<SpawnRequest> mSpawnQueue;
+
+        quartz::TripleBuffer<ParticleSnapshot> mSnapshots;
+};
@@ -0,0 +1,55 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/core/utils/task_pool.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+#include "sapphire/utility/config.hpp"
+#include "sapphire/components/density_component.hpp"
+#include "sapphire/components/mass_component.hpp"
+#include "sapphire/components/pressure_component.hpp"
+#include "sapphire/components/velocity_component.hpp"
+#include "sapphire/components/time_step_component.hpp"
+
+// Removes particles that left the domain box, or whose position is no longer finite,
+// and appends their last state to the escape log
+class DomainCullingSystem {
+    public:
+        DomainCullingSystem(
+            const glm::vec3& domainMin = glm::vec3(sapphire_config::DOMAIN_MIN),
+            const glm::vec3& domainMax = glm::vec3(sapphire_config::DOMAIN_MAX)
+        ) : mDomainMin(domainMin), mDomainMax(domainMax) {}
+
+        // Returns how many particles were removed
+        size_t Update(bismuth::Registry& registry);
+
+        void SetBounds(const glm::vec3& domainMin, const glm::vec3& domainMax);
+        // Empty path = escaped particles are removed without a record
+        void SetLogPath(const std::string& logPath);
+
+        size_t GetEscapedCount() const;
+
+    private:
+        void WriteLog(bismuth::Registry& registry);
+
+    private:
+        glm::vec3 mDomainMin;
+        glm::vec3 mDomainMax;
+
+        std::string mLogPath;
+        std::ofstream mLog;
+
+        std::vector<uint32_t> mEscaped;
+        size_t mEscapedCount = 0;
+};
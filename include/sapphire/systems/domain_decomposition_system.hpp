@@ -0,0 +1,95 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/core/utils/task_pool.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+#include "sapphire/utility/utility.hpp"
+#include "sapphire/utility/config.hpp"
+#include "sapphire/distributed/transport.hpp"
+#include "sapphire/systems/particle_system.hpp"
+#include "sapphire/components/halo_component.hpp"
+#include "sapphire/components/time_step_component.hpp"
+
+// Splits the particles across processes along a Morton curve of DECOMPOSITION_CELL_SIZE cells.
+// Every rank owns a contiguous key range, particles that move into another range migrate there
+// and particles in cells next to another range are sent to it as halos for one step.
+// Ranges are rebalanced on measured step times
+class DomainDecompositionSystem {
+    public:
+        DomainDecompositionSystem(std::shared_ptr<ITransport> transport, float cellSize = sapphire_config::DECOMPOSITION_CELL_SIZE);
+
+        // Migrates, rebalances when due and receives this step's halos
+        void Update(bismuth::Registry& registry);
+        // Leaves only owned particles in the registry
+        void RemoveHalos(bismuth::Registry& registry);
+        // Every rank continues with the smallest step
+        void ReduceTimeStep(bismuth::Registry& registry);
+
+        // Compute time of this rank's last step, without waiting on other ranks
+        void RecordStepTime(double seconds);
+
+        // Initial particles are dealt out round robin, the first Update moves them to their owners
+        bool IsInitialOwner(size_t index) const;
+
+        int GetRank() const;
+        int GetSize() const;
+        size_t GetHaloCount() const;
+
+    private:
+        // State of one particle on the wire
+        struct ParticleRecord {
+            glm::dvec3 position;
+            float      radius;
+            float      mass;
+            glm::vec4  velocity;
+            glm::vec4  force;
+            float      density;
+            float      pressure;
+            float      smoothingLength;
+            float      energy;
+            MaterialType      material;
+            ActivityComponent activity;
+        };
+        static_assert(std::is_trivially_copyable_v<ParticleRecord>);
+
+        int Owner(const glm::ivec3& cell) const;
+
+        void Rebalance(bismuth::Registry& registry);
+        bool RebalanceDue();
+        void Migrate(bismuth::Registry& registry);
+        void SendHalos(bismuth::Registry& registry);
+
+        // One list of entities per destination rank, sorted so messages do not depend on the thread split.
+        // destinations(cell, ranks) appends the ranks a particle in cell goes to
+        template<typename Destinations>
+        std::vector<std::vector<uint32_t>> Route(bismuth::Registry& registry, Destinations destinations);
+
+        std::vector<ParticleRecord> Pack(bismuth::Registry& registry, const std::vector<uint32_t>& entityIDs) const;
+        void Unpack(bismuth::Registry& registry, const std::vector<ParticleRecord>& records, bool halo) const;
+
+    private:
+        std::shared_ptr<ITransport> mTransport;
+        float mCellSize;
+
+        // Rank r owns keys in [mSplitters[r], mSplitters[r+1])
+        std::vector<uint64_t> mSplitters;
+
+        uint32_t mStepCount = 0;
+        double mStepTime = 0.0;     // Summed since the last load check
+        double mParticleCost = 1.0; // Seconds per particle on this rank
+
+        size_t mHaloCount = 0;
+};
@@ -1,12 +1,21 @@
 #pragma once
+// C++ standard libraries
+#include <memory>
+
 // Own libraries
 #include "bismuth/registry.hpp"
-#include "sapphire/components/force_component.hpp"
-#include "sapphire/components/velocity_component.hpp"
-#include "sapphire/components/mass_component.hpp"
-#include "quartz/core/components/sphere_component.hpp"
+#include "sapphire/utility/config.hpp"
+#include "sapphire/integrators/integrator.hpp"
 
 class ForceToPosSystem {
     public:
+        ForceToPosSystem(IntegratorType type = sapphire_config::INTEGRATOR) : mIntegrator(CreateIntegrator(type)) {}
+
+        // Before the spatial/density/force passes
+        void Predict(bismuth::Registry& registry, float deltaTime);
+        // After the force pass
         void Update(bismuth::Registry& registry, float deltaTime);
-};
\ No newline at end of file
+
+    private:
+        std::unique_ptr<IIntegrator> mIntegrator;
+};
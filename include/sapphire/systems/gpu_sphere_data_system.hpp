@@ -4,43 +4,121 @@
 #include "quartz/graphics/shader.hpp"
 #include "sapphire/utility/utility.hpp"
 #include "sapphire/utility/config.hpp"
+#include "sapphire/kernels/kernel_glsl.hpp"
+#include "sapphire/eos/eos_table.hpp"
 #include "sapphire/components/density_component.hpp"
 #include "sapphire/components/force_component.hpp"
 #include "sapphire/components/pressure_component.hpp"
 #include "sapphire/components/velocity_component.hpp"
 #include "sapphire/components/mass_component.hpp"
+#include "sapphire/components/simulation_parameters.hpp"
 #include "quartz/core/components/sphere_component.hpp"
 
 #include "sapphire/components/position_component.hpp"
 #include "sapphire/components/spatial_hash_component.hpp"
 #include "sapphire/utility/data_buffers.hpp"
+#include "sapphire/utility/gpu_profiler.hpp"
+#include "sapphire/utility/gpu_radix_sort.hpp"
+#include "sapphire/utility/reorder_scheduler.hpp"
 
 class GPUSphereDataSystem {
     public:
-        GPUSphereDataSystem(bismuth::Registry& registry);
+        GPUSphereDataSystem(
+            bismuth::Registry& registry, 
+            IntegratorType     integrator = sapphire_config::INTEGRATOR,
+            bool               adaptiveTimeStep = sapphire_config::ADAPTIVE_TIME_STEP,
+            bool               reorder = sapphire_config::MORTON_REORDER,
+            KernelType         kernel = sapphire_config::KERNEL,
+            bool               tiled = sapphire_config::TILED_NEIGHBOR_LOOPS,
+            uint32_t           substeps = sapphire_config::GPU_SUBSTEPS
+        );
 
         void Update(bismuth::Registry& registry, DataBuffers& dataBuffer);
+
+        // Runs the configured number of simulation steps back to back, no drawing
+        void Simulate(bismuth::Registry& registry, DataBuffers& dataBuffer);
+        // Draws positions interpolated across the last Simulate call
+        void Render(bismuth::Registry& registry, DataBuffers& dataBuffer, float alpha);
+
+        // Gpu time of every pass, a frame ends with each Render
+        GPUProfiler& GetProfiler() {
+            return mProfiler;
+        }
     private:
-        void BindSpatial(DataBuffers& dataBuffer);
-        void BindDensity(DataBuffers& dataBuffer);
-        void BindForce(DataBuffers& dataBuffer);
-        void BindPosToForce(DataBuffers& dataBuffer);
+        // Spatial hash, density and forces have the table size compiled in
+        void BuildHashPrograms(uint32_t tableSize);
+        void BindBuffers(DataBuffers& dataBuffer);
+        void UploadParameters(const SimulationParametersComponent& parameters, DataBuffers& dataBuffer);
 
         void ComputeSpatialHash(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer);
         void ComputeDensity(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer);
         void ComputeForces(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer);
-        void ComputePos(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer);
+        void DispatchNeighborLoop(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer);
+        void ComputePos(const std::vector<uint32_t>& denseEntities, uint32_t stage);
+        void ComputeTimeStep(const std::vector<uint32_t>& denseEntities);
 
-        void Render(const std::vector<uint32_t>& denseEntities, bismuth::Registry& registry, DataBuffers& dataBuffer);
+        // Sorts the particle buffer along a Morton curve
+        void Reorder(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer);
+        void PermuteBuffer(GLuint buffer, uint32_t stride, uint32_t count, DataBuffers& dataBuffer);
+        // Feeds finished timer queries to the reorder scheduler
+        void CollectTimings(size_t particleCount);
 
     private:
         // Programs
-        GLuint mDensityProgram;
-        GLuint mForcesProgram;
+        GLuint mDensityProgram     = 0;
+        GLuint mForcesProgram      = 0;
         GLuint mPosProgram;
-        GLuint mSpatialHashProgram;
+        GLuint mSpatialHashProgram = 0;
+        GLuint mTimeStepProgram;
+        GLuint mMortonProgram;
+        GLuint mPermuteProgram;
 
         GLuint mRender;
 
         GLuint mDummyVAO;
+
+        // Equation of state table of sapphire_config::MATERIAL
+        GLuint mEosTexture;
+
+        IntegratorType mIntegrator;
+        bool mAdaptiveTimeStep;
+        // Density and forces run one workgroup per cell key instead of one invocation per particle
+        bool mTiled;
+        uint32_t mSubsteps;
+
+        // Read once, the kernels are generated for it
+        float mSmoothingLength;
+
+        // Compile time values shared by the simulation shaders
+        shader::Defines mDefines;
+        std::string mKernelPrelude;
+        uint32_t mProgramTableSize = 0;
+
+        // Uniforms changed between dispatches
+        int mSpatialStageLocation;
+        int mPosStageLocation;
+        int mPosStorePreviousLocation;
+        int mFinalizeLocation;
+
+        // Last contents of the parameter buffer
+        SimulationParametersComponent mUploadedParameters;
+        bool mParametersUploaded = false;
+
+        // Reordering
+        bool mReorder;
+        GPURadixSort mRadixSort;
+        ReorderScheduler mReorderScheduler;
+
+        GPUProfiler mProfiler;
+
+        GLuint mGatherQuery;
+        GLuint mReorderQuery;
+        bool mGatherQueryPending  = false;
+        bool mReorderQueryPending = false;
+
+        uint64_t mStepCount        = 0;
+        uint64_t mGatherQueryStep  = 0;
+        uint64_t mLastReorderStep  = 0;
+        size_t   mReorderCount     = 0; // Particles sorted by the pending reorder query
+        double   mGatherCost       = -1.0;
 };
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/core/utils/task_pool.hpp"
+#include "sapphire/utility/utility.hpp"
+#include "sapphire/utility/config.hpp"
+#include "sapphire/utility/reorder_scheduler.hpp"
+#include "sapphire/utility/particle_pools.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+
+// Every few steps sorts the particle pools along a Morton curve so neighbors sit close in memory.
+// The interval is picked by a ReorderScheduler fed with the measured gather cost.
+class MortonReorderSystem {
+    public:
+        // Returns true if the pools were reordered
+        bool Update(bismuth::Registry& registry);
+
+        // Wall time of the neighbor/density/force passes of one step
+        void RecordGatherTime(double seconds, size_t particleCount);
+
+        // Previous dense index of every new dense slot, valid after a reorder
+        const std::vector<uint32_t>& GetOrder() const;
+        uint32_t GetInterval() const;
+
+    private:
+        ReorderScheduler mScheduler;
+
+        std::vector<uint64_t> mKeys; // Morton key in the high half, dense index in the low half
+        std::vector<uint32_t> mOrder;
+        std::vector<uint32_t> mEntityOrder;
+};
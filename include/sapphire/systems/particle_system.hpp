@@ -13,12 +13,23 @@
 #include "sapphire/components/pressure_component.hpp"
 #include "sapphire/components/velocity_component.hpp"
 #include "sapphire/components/energy_component.hpp"
+#include "sapphire/components/smoothing_length_component.hpp"
+#include "sapphire/components/activity_component.hpp"
+#include "sapphire/components/precise_position_component.hpp"
+#include "sapphire/components/material_component.hpp"
+#include "sapphire/kernels/kernels.hpp"
+#include "sapphire/eos/equation_of_state.hpp"
+#include "sapphire/utility/config.hpp"
 
 class ParticleSystem {
     public:
         ParticleSystem(bismuth::Registry& registry);
         
-        void CreateParticle(float x, float y, float z, float mass, glm::vec4 velocity);
+        uint32_t CreateParticle(
+            double x, double y, double z, float mass, glm::vec4 velocity,
+            MaterialType material = sapphire_config::MATERIAL,
+            float energy = sapphire_config::INITIAL_ENERGY
+        );
     private:
         bismuth::Registry& mRegistry;
 };
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+// Third_party libraries
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/graphics/shader.hpp"
+#include "quartz/core/components/camera_component.hpp"
+#include "quartz/core/components/transform_component.hpp"
+#include "sapphire/simulation/cpu_simulation.hpp"
+
+// Draws the latest particle snapshot published by a CpuSimulation
+class SnapshotRenderSystem {
+    public:
+        SnapshotRenderSystem();
+
+        void Update(bismuth::Registry& registry, quartz::TripleBuffer<ParticleSnapshot>& snapshots);
+
+    private:
+        GLuint mRender;
+        GLuint mSnapshotData;
+        GLuint mDummyVAO;
+
+        GLint mUniformProjectionMatrix;
+        GLint mUniformCameraPosition;
+
+        size_t mParticleCount = 0;
+};
@@ -1,72 +1,128 @@
 #pragma once
 // C++ standard libraries
-#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
 
 // Third_party libraries
 #include <glm/glm.hpp>
 
 // Own libraries
 #include "bismuth/registry.hpp"
+#include "quartz/core/utils/task_pool.hpp"
 #include "sapphire/utility/utility.hpp"
+#include "sapphire/utility/position_view.hpp"
 #include "sapphire/utility/config.hpp"
+#include "sapphire/kernels/kernels.hpp"
+#include "sapphire/eos/eos_table.hpp"
 #include "sapphire/components/density_component.hpp"
 #include "sapphire/components/force_component.hpp"
 #include "sapphire/components/pressure_component.hpp"
 #include "sapphire/components/velocity_component.hpp"
 #include "sapphire/components/mass_component.hpp"
+#include "sapphire/components/smoothing_length_component.hpp"
+#include "sapphire/components/energy_component.hpp"
+#include "sapphire/components/material_component.hpp"
+#include "sapphire/components/activity_component.hpp"
 #include "quartz/core/components/sphere_component.hpp"
-
-#include "sapphire/components/position_component.hpp"
-#include "sapphire/components/spatial_hash_component.hpp"
+#include "sapphire/neighbors/neighbor_search.hpp"
 
 class SphereDataSystem {
     public:
+        SphereDataSystem(
+            KernelType kernel = sapphire_config::KERNEL,
+            bool adaptiveSmoothing = sapphire_config::ADAPTIVE_SMOOTHING,
+            NeighborSearchType neighborSearch = sapphire_config::NEIGHBOR_SEARCH,
+            bool dormancy = sapphire_config::DORMANCY
+        ) : mKernel(kernel), mAdaptiveSmoothing(adaptiveSmoothing), mDormancy(dormancy), mNeighborSearch(CreateNeighborSearch(neighborSearch)) {}
+
         void Update(bismuth::Registry& registry);
+        // Keeps per particle state in step with a reorder of the dense arrays
+        void ApplyOrder(const std::vector<uint32_t>& order);
     private:
-        void CheckNeighbor(int currentChunk, int& chunkNeighbor, int& neighbor);
-
-        void GetNeighbors(    
-            size_t               const& currentPointID,
-            float                       radius,
-            std::vector<size_t>&        neighbors, 
-            size_t               const& maxParticles,
-
-            SphereComponent      const* positionArray,
-            PositionComponent    const* spatialPosArray,
-            SpatialHashComponent const* spatialHashArray,
-            uint32_t             const* positionLocations,
-            uint32_t             const* spatialPositionLoc,
-            uint32_t             const* spatialHashLocations,
-
-            std::vector<uint32_t>  const& spatialDenseEntities
+        template<typename Kernel>
+        void UpdateWithKernel(bismuth::Registry& registry);
+
+        // Wakes flagged particles and gathers the ones that take part in this step
+        void CollectActive(std::vector<uint32_t> const& sphereIDs, bismuth::ComponentPool<ActivityComponent>& activityPool);
+        void UpdateActivity(
+            size_t                                     entityID,
+            glm::vec3                           const& velocity,
+            glm::vec3                           const& acceleration,
+            std::vector<size_t>                 const& neighbors,
+            bismuth::ComponentPool<ActivityComponent>& activityPool
+        );
+        void FreezeDormant(bismuth::Registry& registry);
+
+        // Newton-Raphson on the number density sum towards TARGET_NEIGHBORS, candidates must cover maxSmoothingLength
+        template<typename Kernel>
+        float SolveSmoothingLength(
+            size_t              const& currentPointID,
+            std::vector<size_t> const& candidateIDs,
+            float                      smoothingLength,
+            float                      maxSmoothingLength,
+
+            sapphire::PositionView const& positions
+        );
+        void FilterNeighbors(
+            size_t              const& currentPointID,
+            std::vector<size_t>&       neighbors,
+            float                      radius,
+
+            sapphire::PositionView const& positions
         );
 
-        float ComputePressure(float& density);
+        float ComputePressure(float density, float energy, MaterialType material);
+
+        template<typename Kernel>
         float ComputeDensity(
             size_t              const& currentPointID,
             std::vector<size_t> const& neighborIDs,
             float                      smoothingLength,
             float                      mass,
             
-            SphereComponent     const* positionArray,
-            uint32_t            const* positionLocations    
+            sapphire::PositionView const& positions
         );
 
+        template<typename Kernel>
         glm::vec4 ComputeForces(
-            size_t            const&   currentPointID,
-            float                      smoothingLength,
-            float                      softening,
-            std::vector<size_t> const& neighbors,
-            
-            SphereComponent   const*   positionArray,
-            VelocityComponent const*   velocityArray,
-            DensityComponent  const*   densityArray,
-            PressureComponent const*   pressureArray,
-            MassComponent     const*   massArray,
-            uint32_t          const*   positionLocations,
-            uint32_t          const*   densityLocations,
-            uint32_t          const*   pressureLocations,
-            uint32_t          const*   velocityLocations,
-            uint32_t          const*   massLocations
+            size_t                   const& currentPointID,
+            float                           softening,
+            std::vector<size_t>      const& neighbors,
+
+            sapphire::PositionView   const& positions,
+            VelocityComponent        const* velocityArray,
+            DensityComponent         const* densityArray,
+            PressureComponent        const* pressureArray,
+            MassComponent            const* massArray,
+            SmoothingLengthComponent const* smoothingArray,
+            uint32_t                 const* densityLocations,
+            uint32_t                 const* pressureLocations,
+            uint32_t                 const* velocityLocations,
+            uint32_t                 const* massLocations,
+            uint32_t                 const* smoothingLocations
         );
+
+    private:
+        KernelType mKernel;
+        bool mAdaptiveSmoothing;
+        bool mDormancy;
+        std::unique_ptr<INeighborSearch> mNeighborSearch;
+
+        std::vector<float> mSearchRadii;
+
+        // Adaptive smoothing, active index per entity and the pairs each particle adds to its neighbors' lists
+        std::vector<uint32_t> mActiveSlots;
+        std::vector<std::vector<uint32_t>> mReverseNeighbors;
+
+        // Particles that are not dormant, their dense index and neighbor count
+        std::vector<uint32_t> mActiveIDs;
+        std::vector<uint32_t> mActiveIndices;
+        std::vector<uint32_t> mActiveCosts;
+
+        // Per particle neighbor count, used to partition the parallel passes by cost
+        std::vector<uint32_t> mNeighborCosts;
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/core/utils/task_pool.hpp"
+#include "sapphire/utility/config.hpp"
+#include "sapphire/components/force_component.hpp"
+#include "sapphire/components/velocity_component.hpp"
+#include "sapphire/components/mass_component.hpp"
+#include "sapphire/components/time_step_component.hpp"
+#include "sapphire/components/smoothing_length_component.hpp"
+#include "sapphire/components/density_component.hpp"
+#include "sapphire/components/energy_component.hpp"
+#include "sapphire/components/material_component.hpp"
+#include "sapphire/eos/eos_table.hpp"
+#include "sapphire/kernels/kernels.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+
+// Picks the largest stable global step from the CFL, force and viscosity criteria
+// and writes it into the TimeStepComponent singleton
+class TimeStepSystem {
+    public:
+        TimeStepSystem(bool adaptive = sapphire_config::ADAPTIVE_TIME_STEP) : mAdaptive(adaptive) {}
+
+        void Update(bismuth::Registry& registry);
+
+        static float ComputeTimeStep(float maxSpeed, float maxAcceleration, float smoothingLength, float soundSpeed);
+
+    private:
+        bool mAdaptive;
+};
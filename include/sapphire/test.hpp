@@ -3,6 +3,7 @@
 #include "./bismuth/registry.hpp"
 #include "quartz/core/components/sphere_component.hpp"
 #include "./quartz/core/components/instance_component.hpp"
+#include "./quartz/core/utils/task_pool.hpp"
 
 class TestSystem {
     public:
@@ -1,22 +1,108 @@
 #pragma once
+// Own libraries
+#include "sapphire/eos/material_type.hpp"
+#include "sapphire/integrators/integrator_type.hpp"
+#include "sapphire/kernels/kernel_type.hpp"
+#include "sapphire/neighbors/neighbor_search_type.hpp"
 
 namespace sapphire_config {
     constexpr static float G = 1.0f; // TO-DO change to 6.674E-11
     constexpr static float INITIAL_SPACING = 1.0f;
-    constexpr static float SMOOTHING_LENGTH = 2.0f;
+    constexpr static float SMOOTHING_LENGTH = 2.0f; // Kernel support radius, also the neighbor search radius
     constexpr static float TIME_STEP = 0.001f;
 
+    // Positions are kept in double on the cpu, pair differences are rounded to float for the kernels
+    constexpr bool DOUBLE_PRECISION_POSITIONS = false;
+
+    // Kernel
+    constexpr KernelType KERNEL = KernelType::CubicSpline;
+
+    // Adaptive smoothing length
+    constexpr bool ADAPTIVE_SMOOTHING = false;
+    constexpr float TARGET_NEIGHBORS = 50.0f;
+    constexpr float MIN_SUPPORT_RADIUS = 0.25f * SMOOTHING_LENGTH;
+    constexpr float MAX_SUPPORT_RADIUS = 4.0f * SMOOTHING_LENGTH;
+    constexpr int SMOOTHING_ITERATIONS = 4;       // Newton-Raphson iterations per step
+    constexpr float SMOOTHING_TOLERANCE = 1e-3f;  // Relative change of h
+    constexpr float SMOOTHING_SLACK = 1.2f;       // Search radius margin so h can grow within a step
+
+    // Dormancy
+    constexpr bool DORMANCY = false;
+    constexpr float DORMANT_SPEED = 0.05f;        // Below both thresholds a particle counts as calm
+    constexpr float DORMANT_ACCELERATION = 0.05f;
+    constexpr uint32_t DORMANT_STEPS = 32;        // Calm steps before a particle is frozen
+    constexpr float WAKE_FACTOR = 2.0f;           // Neighbors above this multiple of the thresholds wake frozen particles
+
     // Pressure
     constexpr float REST_DENSITY = 0.7f;
     constexpr float STIFFNESS = 100.0f;
 
+    // Equation of state, pressure and sound speed come from a table per material
+    constexpr MaterialType MATERIAL = MaterialType::Fluid; // Default for scene blocks, the only one on the gpu
+    constexpr float INITIAL_ENERGY = 0.0f;          // Specific internal energy, not evolved yet
+    constexpr uint32_t EOS_DENSITY_SAMPLES = 256;
+    constexpr uint32_t EOS_ENERGY_SAMPLES = 256;
+    constexpr float EOS_MAX_COMPRESSION = 4.0f;     // Table covers densities up to this multiple of rest density
+    constexpr float EOS_MAX_ENERGY_FACTOR = 10.0f;  // and energies up to this multiple of complete vaporization
+
+    // Viscosity
+    constexpr float VISCOSITY = 1.0f; // Coefficient of the laplacian viscosity term
+
+    // Integration
+    constexpr IntegratorType INTEGRATOR = IntegratorType::Leapfrog;
+    constexpr bool ADAPTIVE_TIME_STEP = true;
+
+    constexpr float CFL_FACTOR       = 0.3f;  // dt <= C * h / (c + |v|max)
+    constexpr float FORCE_FACTOR     = 0.25f; // dt <= C * sqrt(h / |a|max)
+    constexpr float VISCOSITY_FACTOR = 0.125f;// dt <= C * h^2 / nu
+    constexpr float MIN_TIME_STEP    = 1e-5f;
+    constexpr float MAX_TIME_STEP    = 0.01f;
+
+    // Domain, particles outside are removed and logged
+    constexpr bool DOMAIN_CULLING = true;
+    constexpr float DOMAIN_MIN = -1000.0f; // Same bound on every axis, scenes can set their own box
+    constexpr float DOMAIN_MAX = 1000.0f;
+
     // SpatialHash
     constexpr int SPATIAL_LENGTH = 32;
     constexpr float SPATIAL_LENGTH_MAX = SPATIAL_LENGTH*sapphire_config::SMOOTHING_LENGTH;
     constexpr size_t SPATIAL_SIZE = SPATIAL_LENGTH*SPATIAL_LENGTH*SPATIAL_LENGTH; // 3D
-    constexpr uint32_t HASH_SIZE = 8192;
+    constexpr uint32_t CELL_TABLE_FACTOR = 2; // GPU cell table entries per particle, rounded up to a power of two
+
+    // Neighbor search
+    constexpr NeighborSearchType NEIGHBOR_SEARCH = NeighborSearchType::Grid;
+    constexpr uint32_t KD_TREE_LEAF_SIZE = 16;
+    constexpr uint32_t KD_TREE_MAX_REFITS = 16;     // Steps between full rebuilds at most
+    constexpr float KD_TREE_REFIT_GROWTH = 1.5f;   // Rebuild once the leaf bounds grew by this factor
+    constexpr uint32_t KD_TREE_BATCH_SIZE = 32;     // Queries sharing one traversal
+
+    // Domain decomposition across processes
+    // Cells at least twice the search radius, so halo particles also get complete densities
+    constexpr float DECOMPOSITION_CELL_SIZE = 2.0f * (ADAPTIVE_SMOOTHING ? MAX_SUPPORT_RADIUS * SMOOTHING_SLACK : SMOOTHING_LENGTH);
+    constexpr uint32_t REBALANCE_INTERVAL = 50;  // Steps between load checks
+    constexpr float REBALANCE_IMBALANCE = 1.1f;  // Slowest over mean rank step time that triggers a rebalance
+    constexpr uint32_t REBALANCE_BINS = 1 << 16; // Morton key histogram resolution
+
+    // Reordering
+    constexpr bool MORTON_REORDER = true;
+    constexpr uint32_t MORTON_BITS = 10;             // Per axis, cell coordinates wrap after 2^10
+    constexpr uint32_t MIN_REORDER_INTERVAL = 4;     // Steps
+    constexpr uint32_t MAX_REORDER_INTERVAL = 1024;
 
     // GPU
     constexpr unsigned int WORKGROUP_SIZE = 64;
+    constexpr unsigned int RADIX_WORKGROUP_SIZE = 256;
+    constexpr uint32_t READBACK_RING_SIZE = 3;        // Gpu state copies in flight at once
+    constexpr uint32_t DIAGNOSTICS_INTERVAL = 30;     // Frames between gpu state readbacks for the console diagnostics
+    constexpr size_t MIN_PARTICLE_CAPACITY = 1024;    // Gpu particle buffers start here and double when full
+    constexpr bool TILED_NEIGHBOR_LOOPS = false;      // Density and forces stage neighbor cells in shared memory
+    constexpr uint32_t GPU_SUBSTEPS = 1;              // Simulation steps per fixed update, all queued without cpu round trips
+
+    // Gpu profiling
+    constexpr bool GPU_PROFILING = true;
+    constexpr uint32_t GPU_PROFILER_LATENCY = 4;      // Frames a timer result may take before it is read
+    constexpr uint32_t GPU_PROFILER_WINDOW = 120;     // Frames in the rolling averages
+    constexpr uint32_t GPU_PROFILER_OVERLAY_ROWS = 7;
+    constexpr const char* GPU_PROFILER_CSV = "";      // Per pass frame times, empty disables the log
 
-}
\ No newline at end of file
+}
@@ -1,10 +1,15 @@
 #pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <vector>
+
 // Third party libraries
 #include <glad/glad.h>
 
 // Own libraries
 #include "bismuth/registry.hpp"
 #include "sapphire/utility/config.hpp"
+#include "sapphire/utility/gpu_readback.hpp"
 #include "sapphire/components/density_component.hpp"
 #include "sapphire/components/force_component.hpp"
 #include "sapphire/components/pressure_component.hpp"
@@ -12,45 +17,102 @@
 #include "sapphire/components/mass_component.hpp"
 #include "quartz/core/components/sphere_component.hpp"
 
+// Mirrors timeStepData in the compute shaders
+struct GPUTimeStep {
+    uint32_t maxSpeedBits        = 0;
+    uint32_t maxAccelerationBits = 0;
+    float    timeStep            = sapphire_config::TIME_STEP;
+    float    simulationTime      = 0.0f;
+};
+
+// Mirrors Particle in the compute shaders, std430 layout.
+// The gpu holds these in its own dense order, the ECS locations stay on the cpu.
+struct GPUParticle {
+    glm::vec4 positionAndRadius;
+    glm::vec4 velocity;
+    glm::vec4 force;
+    float     density;
+    float     pressure;
+    float     mass;
+    uint32_t  entity; // Maps the gpu order back to the ECS on readback
+};
+static_assert(sizeof(GPUParticle) == 64, "GPUParticle must match the std430 layout");
+
+// Mirrors SimulationParameters in the compute shaders, std140 layout
+struct GPUSimulationParameters {
+    glm::vec2 eosOrigin;
+    glm::vec2 eosInverseStep;
+    float     g;
+    float     energy;
+
+    float     timeStep;
+    float     soundSpeed;
+    float     viscosity;
+    float     cflFactor;
+    float     forceFactor;
+    float     viscosityFactor;
+    float     minTimeStep;
+    float     maxTimeStep;
+    float     padding[2];
+};
+static_assert(sizeof(GPUSimulationParameters) == 64, "GPUSimulationParameters must match the std140 layout");
+
 struct DataBuffers {
     void Init(bismuth::Registry& registry);
-    void SyncData(bismuth::Registry& registry);
+    // Queues a copy of the gpu state without blocking, false while the readback ring is full
+    bool RequestSync(size_t particleCount);
+    // Applies the newest landed copy to the registry, false when none landed yet
+    bool PollSync(bismuth::Registry& registry);
+    // Uploads every particle, buffers only grow
     void UpdateBuffers(bismuth::Registry& registry);
+    // Uploads the particles created since the last upload, the rest stays on the gpu
+    void AppendParticles(bismuth::Registry& registry);
+    void AllocateReorderBuffers(size_t particleCount);
+    void AllocateCellGrid(size_t particleCount);
+    // Bound to the particle count so shaders can take the length as the count
+    void BindParticles(GLuint binding) const;
 
     // Helpers
-    template<typename T>
-    void GenerateBuffers(GLuint& buffer, const std::vector<T>& data) {
-        glGenBuffers(1, &buffer);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(T), data.data(), GL_DYNAMIC_COPY);
-    }
-
-    template<typename T>
-    void FillBuffer(GLuint& buffer, const std::vector<T>& data) {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(T), data.data(), GL_DYNAMIC_COPY);
-    }
-
-    // Data SSBO
-    GLuint mSphereData;
-    GLuint mMassData;
-    GLuint mDensityData;
-    GLuint mPressureData;
-    GLuint mForceData;
-    GLuint mVelocityData;
-
-    // Locations SSBO
-    GLuint mSphereLocData;
-    GLuint mMassLocData;
-    GLuint mDensityLocData;
-    GLuint mPressureLocData;
-    GLuint mForceLocData;
-    GLuint mVelocityLocData;
-
-    GLuint mDenseIDs;
-
-    // SparseHash SSBO
-    GLuint mHashTable;
-    GLuint mNextPointers;
-    GLuint mBucketKeys;
-};
\ No newline at end of file
+    bool ApplyReadback(bismuth::Registry& registry, const GPUReadback::Slot& slot);
+    // Gathers dense particles [first, first + count) of the sphere pool from every pool
+    void PackParticles(bismuth::Registry& registry, size_t first, size_t count);
+    void UploadParticles(size_t first);
+    void ReserveParticles(size_t particleCount, bool keepData);
+    void ResizeBuffer(GLuint& buffer, size_t keepSize, size_t capacity);
+
+    // Particle SSBO
+    GLuint mParticleData;
+
+    // Positions before the latest drift, for render interpolation
+    GLuint mPreviousSphereData;
+
+    // SpatialHash SSBO
+    GLuint mCellRanges;      // Start, end pair per key
+    GLuint mCellKeys;
+    GLuint mCellRanks;
+    GLuint mSortedIDs;
+    GLuint mSortedPositions;
+
+    uint32_t mCellTableSize = 0; // Power of two, grows with the particle count
+
+    // Integration SSBO
+    GLuint mTimeStepData;
+
+    // Simulation parameters UBO, rewritten only when a parameter changes
+    GLuint mParameterData;
+
+    // Reordering SSBO
+    GLuint mSortKeys;
+    GLuint mSortValues;
+    GLuint mReorderScratch; // Room for one GPUParticle per particle
+
+    GPUReadback mReadback;
+
+    // Particles on the gpu, the capacity grows geometrically
+    size_t mParticleCount    = 0;
+    size_t mParticleCapacity = 0;
+
+    // Staging for uploads
+    std::vector<GPUParticle> mPacked;
+    std::vector<glm::vec4>   mPackedPositions;
+};
@@ -0,0 +1,87 @@
+#pragma once
+// C++ standard libraries
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Third party libraries
+#include <glad/glad.h>
+
+// Own libraries
+#include "sapphire/utility/config.hpp"
+
+// Per pass gpu times from timestamp queries kept in a ring of frames.
+// Results are read latency frames later and only once they are available,
+// a frame is skipped instead of waiting when the gpu falls further behind.
+// Needs a gl context.
+class GPUProfiler {
+    public:
+        struct Pass {
+            std::string name;
+            std::vector<double> history; // Milliseconds per frame
+            double sum = 0.0;
+            size_t next = 0;
+            size_t count = 0;
+
+            double GetAverage() const {
+                return count > 0 ? sum / count : 0.0;
+            }
+        };
+
+        GPUProfiler(
+            uint32_t latency = sapphire_config::GPU_PROFILER_LATENCY,
+            uint32_t window  = sapphire_config::GPU_PROFILER_WINDOW,
+            bool     enabled = sapphire_config::GPU_PROFILING
+        );
+        ~GPUProfiler();
+
+        // Passes do not nest, a pass seen several times in a frame is summed
+        void Begin(const std::string& pass);
+        void End();
+
+        // Closes the frame and reads the oldest one if it has finished. Never blocks.
+        void NextFrame();
+
+        // Appends frame,pass,milliseconds rows
+        void OpenLog(const std::string& path);
+
+        // In the order the passes first ran
+        const std::vector<Pass>& GetPasses() const {
+            return mPasses;
+        }
+        // Rolling averages on one line, for the console
+        std::string GetSummary() const;
+
+    private:
+        struct Sample {
+            uint32_t pass;
+            GLuint start;
+            GLuint end;
+        };
+
+        struct Frame {
+            std::vector<Sample> samples;
+            uint64_t index = 0;
+        };
+
+        uint32_t FindPass(const std::string& name);
+        GLuint AcquireQuery();
+        void Resolve(Frame& frame);
+
+    private:
+        bool mEnabled = false;
+        uint32_t mWindow;
+
+        std::vector<Frame> mFrames;
+        uint32_t mCurrent = 0;
+        bool mRecording = true; // False while the frame's slot still waits for results
+        bool mOpen = false;
+
+        std::vector<Pass> mPasses;
+        std::vector<GLuint> mFreeQueries;
+        std::vector<GLuint> mQueries; // Every query ever created
+
+        uint64_t mFrameIndex = 0;
+        std::ofstream mLog;
+};
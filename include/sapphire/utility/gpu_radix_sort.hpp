@@ -0,0 +1,34 @@
+#pragma once
+// C++ standard libraries
+#include <cstdint>
+#include <utility>
+
+// Third party libraries
+#include <glad/glad.h>
+
+// Own libraries
+#include "quartz/graphics/shader.hpp"
+#include "sapphire/utility/config.hpp"
+
+// Stable LSD radix sort of uint key/value pairs held in SSBOs, 4 bits per pass.
+// Needs a gl context.
+class GPURadixSort {
+    public:
+        GPURadixSort();
+
+        // Sorts by the low keyBits of each key, the result ends up back in keys and values
+        void Sort(GLuint keys, GLuint values, uint32_t count, uint32_t keyBits);
+
+    private:
+        void Reserve(uint32_t count, uint32_t groupCount);
+
+    private:
+        GLuint mProgram;
+
+        GLuint mScratchKeys   = 0;
+        GLuint mScratchValues = 0;
+        GLuint mCounts        = 0;
+
+        uint32_t mCapacity       = 0;
+        uint32_t mCountsCapacity = 0;
+};
@@ -0,0 +1,58 @@
+#pragma once
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+// Third party libraries
+#include <glad/glad.h>
+
+// Own libraries
+#include "sapphire/utility/config.hpp"
+
+// Ring of persistently mapped staging buffers filled by buffer copies.
+// A request only queues the copies and a fence, the data is read frames later
+// once the fence has signaled. Buffers are created on first use, needs a gl context.
+class GPUReadback {
+    public:
+        struct Source {
+            GLuint buffer;
+            size_t size; // Bytes from the start of the buffer
+        };
+
+        struct Slot {
+            GLuint buffer   = 0;
+            std::byte* data = nullptr;
+            size_t capacity = 0;
+
+            GLsync fence = nullptr;
+            bool landed  = false;
+            uint64_t sequence = 0;
+
+            std::vector<size_t> offsets;
+            std::vector<size_t> sizes;
+
+            const std::byte* GetData(size_t source) const {
+                return data + offsets[source];
+            }
+        };
+
+        GPUReadback(uint32_t ringSize = sapphire_config::READBACK_RING_SIZE);
+
+        // Queues copies of the sources, false when every slot is still in flight
+        bool Request(std::initializer_list<Source> sources);
+
+        // Newest copy that landed since the last call, nullptr when none did. Never blocks.
+        // Stays valid until the next request.
+        const Slot* Poll();
+
+    private:
+        void Reserve(Slot& slot, size_t size);
+        bool IsSignaled(GLsync fence, GLbitfield flags, GLuint64 timeout);
+
+    private:
+        std::vector<Slot> mSlots;
+        uint32_t mHead = 0; // Next slot to fill, also the oldest one
+        uint64_t mSequence = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "quartz/core/utils/task_pool.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+#include "sapphire/utility/config.hpp"
+#include "sapphire/components/activity_component.hpp"
+#include "sapphire/components/density_component.hpp"
+#include "sapphire/components/energy_component.hpp"
+#include "sapphire/components/force_component.hpp"
+#include "sapphire/components/mass_component.hpp"
+#include "sapphire/components/material_component.hpp"
+#include "sapphire/components/precise_position_component.hpp"
+#include "sapphire/components/pressure_component.hpp"
+#include "sapphire/components/smoothing_length_component.hpp"
+#include "sapphire/components/velocity_component.hpp"
+
+namespace sapphire {
+    // Calls function(pool) on every pool that holds one component per particle, in a fixed order
+    template<typename Function>
+    void ForEachParticlePool(bismuth::Registry& registry, Function&& function) {
+        function(registry.GetComponentPool<SphereComponent>());
+        function(registry.GetComponentPool<VelocityComponent>());
+        function(registry.GetComponentPool<ForceComponent>());
+        function(registry.GetComponentPool<MassComponent>());
+        function(registry.GetComponentPool<DensityComponent>());
+        function(registry.GetComponentPool<PressureComponent>());
+        function(registry.GetComponentPool<SmoothingLengthComponent>());
+        function(registry.GetComponentPool<EnergyComponent>());
+        function(registry.GetComponentPool<MaterialComponent>());
+        function(registry.GetComponentPool<ActivityComponent>());
+        if(sapphire_config::DOUBLE_PRECISION_POSITIONS) {
+            function(registry.GetComponentPool<PrecisePositionComponent>());
+        }
+    }
+
+    // Same split as a plain TaskPool::ParallelFor over the particles, so each worker writes the range it later reads
+    inline void TaskPoolFor(size_t begin, size_t end, const quartz::TaskPool::RangeFunction& body) {
+        quartz::TaskPool::Get().ParallelFor(begin, end, body);
+    }
+
+    // Rewrites every particle array from the task pool workers, pages follow their threads' memory nodes
+    inline void FirstTouchParticles(bismuth::Registry& registry) {
+        ForEachParticlePool(registry, [](auto& pool) {
+            pool.FirstTouch(TaskPoolFor);
+        });
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+// C++ standard libraries
+#include <cstdint>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "sapphire/utility/config.hpp"
+#include "sapphire/components/precise_position_component.hpp"
+#include "quartz/core/components/sphere_component.hpp"
+
+namespace sapphire {
+
+// Particle positions as seen by the pair loops. With DOUBLE_PRECISION_POSITIONS the difference
+// is taken in double and rounded afterwards, so kernels stay in float without losing digits far from the origin
+struct PositionView {
+    SphereComponent          const* sphereArray;
+    uint32_t                 const* sphereLocations;
+    PrecisePositionComponent const* preciseArray;
+    uint32_t                 const* preciseLocations;
+
+    explicit PositionView(bismuth::Registry& registry) {
+        auto& spherePool  = registry.GetComponentPool<SphereComponent>();
+        auto& precisePool = registry.GetComponentPool<PrecisePositionComponent>();
+
+        sphereArray      = spherePool.GetDenseComponents().data();
+        sphereLocations  = spherePool.GetComponentLocations().data();
+        preciseArray     = precisePool.GetDenseComponents().data();
+        preciseLocations = precisePool.GetComponentLocations().data();
+    }
+
+    // Position of a minus position of b
+    glm::vec3 Difference(size_t a, size_t b) const {
+        if constexpr(sapphire_config::DOUBLE_PRECISION_POSITIONS) {
+            return glm::vec3(preciseArray[preciseLocations[a]].position - preciseArray[preciseLocations[b]].position);
+        } else {
+            return glm::vec3(sphereArray[sphereLocations[a]].positionAndRadius) - glm::vec3(sphereArray[sphereLocations[b]].positionAndRadius);
+        }
+    }
+};
+
+// Moves a particle, keeping the rounded sphere position in step with the precise one
+inline void Translate(
+    bismuth::ComponentPool<SphereComponent>&          spherePool,
+    bismuth::ComponentPool<PrecisePositionComponent>& precisePool,
+    size_t                                            entityID,
+    const glm::vec4&                                  displacement
+) {
+    glm::vec4& sphere = spherePool.GetComponent(entityID).positionAndRadius;
+
+    if constexpr(sapphire_config::DOUBLE_PRECISION_POSITIONS) {
+        glm::dvec3& position = precisePool.GetComponent(entityID).position;
+        position += glm::dvec3(glm::vec3(displacement));
+        sphere = glm::vec4(glm::vec3(position), sphere.w);
+    } else {
+        sphere += displacement;
+    }
+}
+
+}
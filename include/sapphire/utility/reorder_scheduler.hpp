@@ -0,0 +1,65 @@
+#pragma once
+// C++ standard libraries
+#include <algorithm>
+#include <cstdint>
+
+// Own libraries
+#include "sapphire/utility/config.hpp"
+
+// Picks when to reorder particle storage from measured costs.
+// Gather cost grows as particles drift from their sorted order, a reorder is due
+// once the cost paid above the post-reorder baseline exceeds the cost of a reorder.
+class ReorderScheduler {
+    public:
+        ReorderScheduler(
+            uint32_t minInterval = sapphire_config::MIN_REORDER_INTERVAL,
+            uint32_t maxInterval = sapphire_config::MAX_REORDER_INTERVAL
+        ) : mMinInterval(minInterval), mMaxInterval(maxInterval) {}
+
+        // Gather cost of one step, any unit as long as reorder cost uses the same one
+        void RecordStepCost(double cost) {
+            mStepsSinceReorder++;
+
+            if(mBaseline < 0.0) {
+                mBaseline = cost;
+                return;
+            }
+            mExcess += std::max(0.0, cost - mBaseline);
+            // Keep the baseline at the best cost seen since the reorder
+            mBaseline = std::min(mBaseline, cost);
+        }
+
+        void RecordReorderCost(double cost) {
+            mReorderCost = cost;
+        }
+
+        bool ShouldReorder() const {
+            if(mStepsSinceReorder < mMinInterval) {
+                return false;
+            }
+            return mStepsSinceReorder >= mMaxInterval || mExcess >= mReorderCost;
+        }
+
+        void Reordered() {
+            mInterval = mStepsSinceReorder;
+            mStepsSinceReorder = 0;
+            mBaseline = -1.0;
+            mExcess = 0.0;
+        }
+
+        // Steps between the last two reorders
+        uint32_t GetInterval() const {
+            return mInterval;
+        }
+
+    private:
+        uint32_t mMinInterval;
+        uint32_t mMaxInterval;
+
+        uint32_t mStepsSinceReorder = 0;
+        uint32_t mInterval = 0;
+
+        double mBaseline = -1.0;
+        double mExcess = 0.0;
+        double mReorderCost = 0.0;
+};
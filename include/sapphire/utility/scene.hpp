@@ -0,0 +1,40 @@
+#pragma once
+// C++ standard libraries
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+// Third_party libraries
+#include <glm/glm.hpp>
+#include <nlohmann/json.hpp>
+
+// Own libraries
+#include "sapphire/utility/config.hpp"
+
+// Cube of particles placed on a regular lattice
+struct SceneBlock {
+    glm::vec3  center   = glm::vec3(0.0f);
+    glm::ivec3 count    = glm::ivec3(25);
+    float      spacing  = sapphire_config::INITIAL_SPACING;
+    float      mass     = 0.3f;
+    glm::vec4  velocity = glm::vec4(0.0f);
+    MaterialType material = sapphire_config::MATERIAL;
+    float      energy   = sapphire_config::INITIAL_ENERGY;
+};
+
+struct Scene {
+    int steps          = 1000;
+    int outputInterval = 100; // Steps between snapshots, 0 = only the last one
+    std::string outputDirectory = "./output";
+    NeighborSearchType neighborSearch = sapphire_config::NEIGHBOR_SEARCH;
+
+    glm::vec3 domainMin = glm::vec3(sapphire_config::DOMAIN_MIN);
+    glm::vec3 domainMax = glm::vec3(sapphire_config::DOMAIN_MAX);
+
+    std::vector<SceneBlock> blocks;
+};
+
+namespace sapphire {
+    Scene LoadScene(const std::string& scenePath);
+}
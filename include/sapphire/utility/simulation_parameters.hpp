@@ -0,0 +1,16 @@
+#pragma once
+// C++ standard libraries
+#include <string>
+#include <fstream>
+#include <iostream>
+
+// Third_party libraries
+#include <nlohmann/json.hpp>
+
+// Own libraries
+#include "sapphire/components/simulation_parameters.hpp"
+
+namespace sapphire {
+    // Reads the "parameters" section of the config, missing entries keep their defaults
+    SimulationParametersComponent LoadSimulationParameters(const std::string& configPath);
+}
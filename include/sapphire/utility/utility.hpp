@@ -1,5 +1,6 @@
 #pragma once
 // C++ standard libraries
+#include <cstdint>
 #include <vector>
 
 // Third_party libraries
@@ -8,11 +9,10 @@
 namespace sapphire {
     static constexpr float PI = 3.14159265358979323846;
 
-    float CubicSplineKernel(const float& radius, const float& smoothingLength);
-    float CubicSplineDerivative(const float& radius, const float& smoothingLength);
-    
-    glm::vec3 CubicSplineGradient(const glm::vec3& deltaPoint, const float& radius, const float& smoothingLength);
-    float CubicSplineLaplacian(const float& radius, const float& smoothingLength);
+    // Interleaves the cell coordinates of position, cells wrap every 2^MORTON_BITS
+    uint32_t MortonKey(const glm::vec3& position, float cellSize);
+    uint32_t MortonKey(const glm::ivec3& cell);
+    glm::ivec3 MortonCell(const glm::vec3& position, float cellSize);
 
     inline float Dot(const glm::vec3& a, const glm::vec3& b) {
         return a.x*b.x + a.y*b.y + a.z*b.z;
@@ -0,0 +1,21 @@
+// Needs CELL_SIZE and HASH_SIZE, a power of two
+
+uint HashFunction(ivec3 gridCell) {
+    const uint p1 = 73856093, p2 = 19349663, p3 = 83492791;
+    return (gridCell.x * p1 ^ gridCell.y * p2 ^ gridCell.z * p3) & (HASH_SIZE - 1u);
+}
+
+ivec3 GridCell(vec3 position) {
+    return ivec3(floor(position / CELL_SIZE));
+}
+
+// Neighboring cells can share a key, each range is read once
+bool FirstVisit(uint key, inout uint visitedKeys[27], inout uint visitedCount) {
+    for(uint i = 0u; i < visitedCount; i++) {
+        if(visitedKeys[i] == key) {
+            return false;
+        }
+    }
+    visitedKeys[visitedCount++] = key;
+    return true;
+}
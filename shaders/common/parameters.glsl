@@ -0,0 +1,17 @@
+// Mirrors GPUSimulationParameters, rewritten only when a parameter changes.
+// Values fixed for a run are injected as defines instead.
+layout(std140, binding = 0) uniform SimulationParameters {
+    vec2  uEosOrigin;
+    vec2  uEosInverseStep;
+    float uG;
+    float uEnergy; // No energy buffer yet, every particle shares it
+
+    float uTimeStep;
+    float uSoundSpeed;
+    float uViscosity;
+    float uCflFactor;
+    float uForceFactor;
+    float uViscosityFactor;
+    float uMinTimeStep;
+    float uMaxTimeStep;
+};
@@ -0,0 +1,12 @@
+// Mirrors GPUParticle, one entry per particle in dense order
+struct Particle {
+    vec4  positionAndRadius;
+    vec4  velocity;
+    vec4  force;
+    float density;
+    float pressure;
+    float mass;
+    uint  entity;
+};
+
+layout(std430, binding = 0) buffer particleData { Particle particles[]; };
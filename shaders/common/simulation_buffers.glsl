@@ -0,0 +1,20 @@
+// Binding layout shared by the simulation shaders, bound once per GPUSphereDataSystem::Simulate
+#include "particle.glsl"
+
+// Positions before the first drift of a frame, for render interpolation
+layout(std430, binding = 1) buffer previousSphere { vec4 previousPositionAndRadius[]; };
+
+layout(std430, binding = 2) buffer timeStepData {
+    uint  maxSpeedBits;        // Positive floats keep their order as uint
+    uint  maxAccelerationBits;
+    float timeStep;
+    float simulationTime;
+};
+
+// SpatialHash, particle indices sorted by key with a start, end pair per key.
+// End holds the count until the scan.
+layout(std430, binding = 3) buffer cellRanges    { uint ranges[];          };
+layout(std430, binding = 4) buffer cellKeys      { uint keys[];            };
+layout(std430, binding = 5) buffer cellRanks     { uint ranks[];           };
+layout(std430, binding = 6) buffer sortedIndices { uint sortedIDs[];       };
+layout(std430, binding = 7) buffer sortedSpheres { vec4 sortedPositions[]; };
@@ -1,85 +1,90 @@
 #version 450 core
-layout(local_size_x = 64) in;
+layout(local_size_x = WORKGROUP_SIZE) in;
 
-// Dense components array
-layout(std430, binding = 0) buffer sphereComponent      { vec4  positionAndRadius[]; };
-layout(std430, binding = 1) buffer pressureComponent    { float pressure[];          };
-layout(std430, binding = 2) buffer densityComponent     { float densities[];         };
-layout(std430, binding = 3) buffer massComponent        { float mass[];              };
+#include "../common/simulation_buffers.glsl"
+#include "../common/parameters.glsl"
+#include "../common/hash.glsl"
 
-// Component locations
-layout(std430, binding = 4) buffer sphereComponentLoc   { uint sphereIDs[];          };
-layout(std430, binding = 5) buffer pressureComponentLoc { uint pressureIDs[];        };
-layout(std430, binding = 6) buffer densityComponentLoc  { uint densityIDs[];         };
-layout(std430, binding = 7) buffer massComponentLoc     { uint massIDs[];            };
+// Equation of state, x = pressure, y = sound speed over (density, energy)
+layout(binding = 0) uniform sampler2D uEosTable;
 
-layout(std430, binding = 8) buffer denseSphereIDs       { uint denseIDs[];           };
 
-// SpatialHash
-layout(std430, binding = 9) buffer hashTable            { uint bucketHeads[];       };
-layout(std430, binding = 10) buffer nextPointers        { uint next[];              };
-layout(std430, binding = 11) buffer bucketKeys          { uint keys[];              };
+// Helper functions
+// KernelW comes from the prelude generated by sapphire::GenerateKernelGLSL
 
-// Uniforms
-uniform float uStiffness;
-uniform float uRestDensity;
-uniform float uSmoothingLength;
+float ComputeDensity(uint currentID) {
+    float density = 0.0f;
 
-uniform float uCellSize;
-uniform uint uHashSize;
+    vec3 pointPos = particles[currentID].positionAndRadius.xyz;
+    ivec3 centerCell = GridCell(pointPos);
 
+    uint visitedKeys[27];
+    uint visitedCount = 0u;
 
-// Helper functions
-float CubicSplineKernel(float radius) {
-    const float PI = 3.14159265358979323846f;
+    for(int x = -1; x <= 1; x++) {
+        for(int y = -1; y <= 1; y++) {
+            for(int z = -1; z <= 1; z++) {
+                uint targetBucketKey = HashFunction(centerCell + ivec3(x, y, z));
+                if(!FirstVisit(targetBucketKey, visitedKeys, visitedCount)) {
+                    continue;
+                }
 
-    float q = radius / uSmoothingLength; // normalizedDistance
-    if (q < 0) return 0.0f;
-    if (q >= 2.0f) return 0.0f;
+                uint end = ranges[2u * targetBucketKey + 1u];
+                for(uint slot = ranges[2u * targetBucketKey]; slot < end; slot++) {
+                    vec3 dist = pointPos - sortedPositions[slot].xyz;
+                    float radius = length(dist);
 
-    const float normalization = 1.0f / (PI * uSmoothingLength * uSmoothingLength * uSmoothingLength);
-    if (q <= 1.0f) {
-        return normalization * (1.0f - 1.5f*q*q + 0.75f*q*q*q);
+                    if(radius <= SMOOTHING_LENGTH) {
+                        density += particles[sortedIDs[slot]].mass * KernelW(radius);
+                    }
+                }
+            }
+        }
     }
-    
-    float t = 2.0f - q;
-    return normalization * 0.25f * t * t * t;
-}
 
-uint HashFunction(ivec3 gridCell) {
-    const uint p1 = 73856093, p2 = 19349663, p3 = 83492791;
-    return (gridCell.x * p1 ^ gridCell.y * p2 ^ gridCell.z * p3) & (uHashSize - 1);
+    return max(density, 1e-5f);
 }
 
-float ComputeDensity(uint currentSphereID) {
+#ifdef TILED
+shared vec4  tilePositions[gl_WorkGroupSize.x];
+shared float tileMasses[gl_WorkGroupSize.x];
+shared ivec3 groupCell;
+shared uint  groupMixed;
+
+// Every invocation shares centerCell, so the loops and barriers stay uniform
+float ComputeTiledDensity(vec3 pointPos, ivec3 centerCell) {
+    uint localID = gl_LocalInvocationID.x;
     float density = 0.0f;
 
-    vec3 pointPos = positionAndRadius[sphereIDs[currentSphereID]].xyz;
-    ivec3 centerCell = ivec3(floor(pointPos / uCellSize));
+    uint visitedKeys[27];
+    uint visitedCount = 0u;
 
-    // Find neighbors directly because I don't have enough memory on the gpu
     for(int x = -1; x <= 1; x++) {
         for(int y = -1; y <= 1; y++) {
             for(int z = -1; z <= 1; z++) {
-                ivec3 neighborCell = centerCell + ivec3(x, y, z);
-                uint targetBucketKey = HashFunction(neighborCell);
-
-                if(targetBucketKey >= bucketHeads.length()) {
+                uint targetBucketKey = HashFunction(centerCell + ivec3(x, y, z));
+                if(!FirstVisit(targetBucketKey, visitedKeys, visitedCount)) {
                     continue;
                 }
 
-                uint neighborID = bucketHeads[targetBucketKey];
+                uint end = ranges[2u * targetBucketKey + 1u];
+                for(uint tileStart = ranges[2u * targetBucketKey]; tileStart < end; tileStart += gl_WorkGroupSize.x) {
+                    uint slot = tileStart + localID;
+                    if(slot < end) {
+                        tilePositions[localID] = sortedPositions[slot];
+                        tileMasses[localID]    = particles[sortedIDs[slot]].mass;
+                    }
+                    barrier();
 
-                while(neighborID != 0xFFFFFFFF) {
-                    if(keys[neighborID] == targetBucketKey) {
-                        vec3 dist = pointPos - positionAndRadius[sphereIDs[neighborID]].xyz;
-                        float radius = length(dist);
+                    uint tileSize = min(gl_WorkGroupSize.x, end - tileStart);
+                    for(uint i = 0u; i < tileSize; i++) {
+                        float radius = length(pointPos - tilePositions[i].xyz);
 
-                        if(radius <= uSmoothingLength) {
-                            density += mass[massIDs[neighborID]] * CubicSplineKernel(radius);
+                        if(radius <= SMOOTHING_LENGTH) {
+                            density += tileMasses[i] * KernelW(radius);
                         }
                     }
-                    neighborID = next[neighborID];
+                    barrier();
                 }
             }
         }
@@ -87,21 +92,78 @@ float ComputeDensity(uint currentSphereID) {
 
     return max(density, 1e-5f);
 }
+#endif
 
+// Same lookup as sapphire::EosTable::Evaluate, edge cells extrapolate
 float ComputePressure(float density) {
-    return uStiffness * (density - uRestDensity);
+    vec2 coord = (vec2(density, uEnergy) - uEosOrigin) * uEosInverseStep;
+    ivec2 cell = clamp(ivec2(floor(coord)), ivec2(0), textureSize(uEosTable, 0) - 2);
+    vec2 t = coord - vec2(cell);
+
+    float p00 = texelFetch(uEosTable, cell,               0).x;
+    float p10 = texelFetch(uEosTable, cell + ivec2(1, 0), 0).x;
+    float p01 = texelFetch(uEosTable, cell + ivec2(0, 1), 0).x;
+    float p11 = texelFetch(uEosTable, cell + ivec2(1, 1), 0).x;
+
+    return mix(mix(p00, p10, t.x), mix(p01, p11, t.x), t.y);
 }
 
+#ifdef TILED
+// One workgroup per key, the key's particles are taken a workgroup at a time.
+// Groups stride over the table when it has more keys than a dispatch allows
+void main() {
+    uint localID = gl_LocalInvocationID.x;
+
+    for(uint key = gl_WorkGroupID.x; key < HASH_SIZE; key += gl_NumWorkGroups.x) {
+        uint start = ranges[2u * key];
+        uint end   = ranges[2u * key + 1u];
+
+        for(uint chunkStart = start; chunkStart < end; chunkStart += gl_WorkGroupSize.x) {
+            uint slot   = chunkStart + localID;
+            bool active = slot < end;
+
+            // Idle invocations follow the first particle so they agree on the cell
+            vec3 pointPos    = sortedPositions[active ? slot : chunkStart].xyz;
+            ivec3 centerCell = GridCell(pointPos);
+
+            if(localID == 0u) {
+                groupCell  = centerCell;
+                groupMixed = 0u;
+            }
+            barrier();
+            if(centerCell != groupCell) {
+                atomicOr(groupMixed, 1u);
+            }
+            barrier();
+            bool mixed = groupMixed != 0u;
+            barrier();
+
+            // Colliding cells share the key but not the neighbors, nothing to tile
+            float density = 0.0f;
+            if(mixed) {
+                density = active ? ComputeDensity(sortedIDs[slot]) : 0.0f;
+            } else {
+                density = ComputeTiledDensity(pointPos, centerCell);
+            }
+
+            if(active) {
+                uint currentID = sortedIDs[slot];
+                particles[currentID].density  = density;
+                particles[currentID].pressure = ComputePressure(density);
+            }
+        }
+    }
+}
+#else
 void main() {
     uint currentID = gl_GlobalInvocationID.x;
-    if(currentID >= denseIDs.length()) {
+    if(currentID >= particles.length()) {
         return;
     }
 
-    uint currentPointID = denseIDs[currentID];
+    float density = ComputeDensity(currentID);
 
-    float density = ComputeDensity(currentPointID);
-
-    densities[densityIDs[currentPointID]] = density;
-    pressure[pressureIDs[currentPointID]] = ComputePressure(density);
-}
\ No newline at end of file
+    particles[currentID].density  = density;
+    particles[currentID].pressure = ComputePressure(density);
+}
+#endif
\ No newline at end of file
@@ -1,28 +1,42 @@
 #version 450 core
-layout(local_size_x = 64) in;
+layout(local_size_x = WORKGROUP_SIZE) in;
 
-layout(std430, binding = 0) buffer sphereComponent      { vec4 positionAndRadius[]; };
-layout(std430, binding = 1) buffer velocityComponent    { vec4 velocity[];          };
-layout(std430, binding = 2) buffer forceComponent       { vec4 force[];             };
-layout(std430, binding = 3) buffer massComponent        { float mass[];             };
+#include "../common/simulation_buffers.glsl"
 
-layout(std430, binding = 4) buffer sphereComponentLoc   { uint sphereIDs[];         };
-layout(std430, binding = 5) buffer velocityComponentLoc { uint velocityIDs[];       };
-layout(std430, binding = 6) buffer forceComponentLoc    { uint forceIDs[];          };
-layout(std430, binding = 7) buffer massComponentLoc     { uint massIDs[];           };
-
-layout(std430, binding = 8) buffer denseSphereIDs       { uint denseIDs[];          };
-
-uniform float uTimeStep;
+// 0 = before the force pass, 1 = after it
+uniform uint uStage;
+// Only the first substep of a frame, render interpolates from the frame's start
+uniform uint uStorePrevious;
 
 void main() {
     uint currentID = gl_GlobalInvocationID.x;
-    if(currentID >= denseIDs.length()) {
+    if(currentID >= particles.length()) {
         return;
     }
 
-    uint currentPointID = denseIDs[currentID];
+    Particle particle = particles[currentID];
+
+    float dt = timeStep;
+    vec3 acceleration = particle.force.xyz / particle.mass;
+
+    // 0 = symplectic euler, 1 = kick-drift-kick (leapfrog and velocity verlet)
+    if(INTEGRATOR == 0) {
+        particle.velocity.xyz += acceleration * dt;
 
-    velocity[velocityIDs[currentPointID]].xyz += (force[forceIDs[currentPointID]].xyz / mass[massIDs[currentPointID]]) * uTimeStep;
-    positionAndRadius[sphereIDs[currentPointID]] += velocity[velocityIDs[currentPointID]] * uTimeStep;
-}
\ No newline at end of file
+        if(uStorePrevious != 0u) {
+            previousPositionAndRadius[currentID] = particle.positionAndRadius;
+        }
+        particles[currentID].positionAndRadius.xyz += particle.velocity.xyz * dt;
+        particles[currentID].velocity = particle.velocity;
+        return;
+    }
+
+    particle.velocity.xyz += acceleration * (0.5f * dt);
+    if(uStage == 0u) {
+        if(uStorePrevious != 0u) {
+            previousPositionAndRadius[currentID] = particle.positionAndRadius;
+        }
+        particles[currentID].positionAndRadius.xyz += particle.velocity.xyz * dt;
+    }
+    particles[currentID].velocity = particle.velocity;
+}
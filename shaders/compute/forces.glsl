@@ -1,161 +1,185 @@
 #version 450 core
-layout(local_size_x = 64) in;
+layout(local_size_x = WORKGROUP_SIZE) in;
 
-// Dense components array
-layout(std430, binding = 0) buffer sphereComponent      { vec4 positionAndRadius[]; };
-layout(std430, binding = 1) buffer velocityComponent    { vec4 velocity[];          };
-layout(std430, binding = 2) buffer pressureComponent    { float pressure[];         };
-layout(std430, binding = 3) buffer densityComponent     { float densities[];        };
-layout(std430, binding = 4) buffer massComponent        { float mass[];             };
-layout(std430, binding = 5) buffer forceComponent       { vec4  force[];            };
-
-// Component locations
-layout(std430, binding = 6) buffer sphereComponentLoc   { uint sphereIDs[];         };
-layout(std430, binding = 7) buffer velocityComponentLoc { uint velocityIDs[];       };
-layout(std430, binding = 8) buffer pressureComponentLoc { uint pressureIDs[];       };
-layout(std430, binding = 9) buffer densityComponentLoc  { uint densityIDs[];        };
-layout(std430, binding = 10) buffer massComponentLoc    { uint massIDs[];           };
-layout(std430, binding = 11) buffer forceComponentLoc   { uint forceIDs[];          };
-
-layout(std430, binding = 12) buffer denseSphereIDs      { uint denseIDs[];          };
-
-// SpatialHash
-layout(std430, binding = 13) buffer hashTable           { uint bucketHeads[];       };
-layout(std430, binding = 14) buffer nextPointers        { uint next[];              };
-layout(std430, binding = 15) buffer bucketKeys          { uint keys[];              };
-
-// Uniforms
-uniform float uSmoothingLength;
-uniform float uG;
-
-uniform float uCellSize;
-uniform uint uHashSize;
+#include "../common/simulation_buffers.glsl"
+#include "../common/parameters.glsl"
+#include "../common/hash.glsl"
 
 
 // Helper functions
-float CubicSplineDerivative(float radius) {
-    const float PI = 3.14159265358979323846f;
+// KernelGradient and KernelLaplacian come from the prelude generated by sapphire::GenerateKernelGLSL
 
-    float normalizedDistance = radius / uSmoothingLength;
-    if(normalizedDistance <= 0.0f || normalizedDistance >= 2.0f) {
-        return 0.0f;
+// Pressure, viscosity and gravity a neighbor exerts on the current point
+vec3 PairForce(vec3 dist, float radiusSquared, vec4 currentData, vec3 currentVelocity, vec4 neighborData, vec3 neighborVelocity) {
+    float radius = sqrt(radiusSquared);
+    if(radius <= 0.0f || radius >= SMOOTHING_LENGTH) {
+        return vec3(0.0f);
     }
 
-    const float normalization = 1.0f / (PI * uSmoothingLength * uSmoothingLength * uSmoothingLength);
-    
-    if(normalizedDistance <= 1.0f) {
-        return normalization * (-3.0f * normalizedDistance + 2.25f * normalizedDistance * normalizedDistance) / uSmoothingLength;
-    } else {
-        float factor = 2.0f - normalizedDistance;
-        return -normalization * 0.75f * factor * factor / uSmoothingLength;
-    }
-}
+    float softening = SMOOTHING_LENGTH * 0.01f;
+    float softeningSquared = softening*softening;
 
-vec3 CubicSplineGradient(vec3 deltaPoint, float radius) {
-    if(radius == 0.0f) {
-        return vec3(0.0f);
-    }
+    // Data is (density, pressure, mass)
+    float neighborDensity = neighborData.x;
+    float neighborMass    = neighborData.z;
 
-    float dwdr = CubicSplineDerivative(radius);
-    return dwdr * (deltaPoint / radius);
-}
+    // Pressure
+    float pressureTerm = (currentData.y / (currentData.x*currentData.x)) +
+        (neighborData.y / (neighborDensity*neighborDensity));
+    vec3 pressureForce = -neighborMass * pressureTerm * KernelGradient(dist, radius);
 
-float CubicSplineLaplacian(float radius) {
-    const float PI = 3.14159265358979323846f;
+    // Viscosity
+    vec3 viscosityForce = uViscosity * neighborMass * (neighborDensity * (neighborVelocity - currentVelocity)) * KernelLaplacian(radius);
 
-    float normalizedDistance = radius / uSmoothingLength;
-    if(normalizedDistance >= 2.0f) {
-        return 0.0f;
-    }
-    if(normalizedDistance == 0.0f) {
-        return 0.0f;
-    }
+    // Gravity
+    float distSoft = radiusSquared + softeningSquared;
+    float denominator = sqrt(distSoft*distSoft*distSoft);
+    vec3 gravityForce = uG * neighborMass * dist / denominator;
 
-    const float normalization = 45.0f / (PI * uSmoothingLength * uSmoothingLength * uSmoothingLength * uSmoothingLength * uSmoothingLength);
-    if(normalizedDistance <= 1.0f) {
-        return normalization * (1.0f - normalizedDistance);
-    } else {
-        return normalization * (2.0f - normalizedDistance) * (2.0f - normalizedDistance) * (2.0f - normalizedDistance);
-    }
+    return pressureForce + viscosityForce + gravityForce;
 }
 
-uint HashFunction(ivec3 gridCell) {
-    const uint p1 = 73856093, p2 = 19349663, p3 = 83492791;
-    return (gridCell.x * p1 ^ gridCell.y * p2 ^ gridCell.z * p3) & (uHashSize - 1);
+vec4 ParticleData(uint id) {
+    return vec4(particles[id].density, particles[id].pressure, particles[id].mass, 0.0f);
 }
 
 // Main Calculations
 vec3 ComputeForce(uint currentID) {
-    float softening = uSmoothingLength * 0.01f;
-    float softeningSquared = softening*softening;
-
-    vec3 pressureForce  = vec3(0.0f);
-    vec3 viscosityForce = vec3(0.0f);
-    vec3 gravityForce   = vec3(0.0f);
+    vec3 force = vec3(0.0f);
 
     // Current point data
-    vec3 currentPointPosition  = positionAndRadius[sphereIDs[currentID]].xyz;
-    vec3 currentPointVelocity  = velocity[velocityIDs[currentID]].xyz;
-    float currentPointPressure = pressure[pressureIDs[currentID]];
-    float currentPointDensity  = densities[densityIDs[currentID]];
+    vec3 currentPointPosition = particles[currentID].positionAndRadius.xyz;
+    vec3 currentPointVelocity = particles[currentID].velocity.xyz;
+    vec4 currentPointData     = ParticleData(currentID);
+
+    ivec3 centerCell = GridCell(currentPointPosition);
 
-    ivec3 centerCell = ivec3(floor(currentPointPosition / uCellSize));
+    uint visitedKeys[27];
+    uint visitedCount = 0u;
 
-    // Find neighbors directly because I don't have enough memory on the gpu
     for(int x = -1; x <= 1; x++) {
         for(int y = -1; y <= 1; y++) {
             for(int z = -1; z <= 1; z++) {
-                ivec3 neighborCell = centerCell + ivec3(x, y, z);
-                uint targetBucketKey = HashFunction(neighborCell);
+                uint targetBucketKey = HashFunction(centerCell + ivec3(x, y, z));
+                if(!FirstVisit(targetBucketKey, visitedKeys, visitedCount)) {
+                    continue;
+                }
+
+                uint end = ranges[2u * targetBucketKey + 1u];
+                for(uint slot = ranges[2u * targetBucketKey]; slot < end; slot++) {
+                    vec3 dist = currentPointPosition - sortedPositions[slot].xyz;
+                    uint neighborID = sortedIDs[slot];
+
+                    force += PairForce(dist, dot(dist, dist), currentPointData, currentPointVelocity,
+                        ParticleData(neighborID), particles[neighborID].velocity.xyz);
+                }
+            }
+        }
+    }
+
+    return force;
+}
+
+#ifdef TILED
+shared vec4  tilePositions[gl_WorkGroupSize.x];
+shared vec4  tileVelocities[gl_WorkGroupSize.x];
+shared vec4  tileData[gl_WorkGroupSize.x];
+shared ivec3 groupCell;
+shared uint  groupMixed;
 
-                if(targetBucketKey >= bucketHeads.length()) {
+// Every invocation shares centerCell, so the loops and barriers stay uniform
+vec3 ComputeTiledForce(vec3 pointPos, vec3 pointVelocity, vec4 pointData, ivec3 centerCell) {
+    uint localID = gl_LocalInvocationID.x;
+    vec3 force = vec3(0.0f);
+
+    uint visitedKeys[27];
+    uint visitedCount = 0u;
+
+    for(int x = -1; x <= 1; x++) {
+        for(int y = -1; y <= 1; y++) {
+            for(int z = -1; z <= 1; z++) {
+                uint targetBucketKey = HashFunction(centerCell + ivec3(x, y, z));
+                if(!FirstVisit(targetBucketKey, visitedKeys, visitedCount)) {
                     continue;
                 }
 
-                uint neighborID = bucketHeads[targetBucketKey];
-
-                while(neighborID != 0xFFFFFFFF) {
-                    if(keys[neighborID] == targetBucketKey) {
-                        vec3 dist = currentPointPosition - positionAndRadius[sphereIDs[neighborID]].xyz;
-                        float radiusSquared = dot(dist, dist);
-                        float radius = sqrt(radiusSquared);
-
-                        if(radius > 0.0f && radius < uSmoothingLength) {
-                            float neighborDensity  = densities[densityIDs[neighborID]];
-                            float neighborPressure = pressure[pressureIDs[neighborID]];
-                            float neighborMass     = mass[massIDs[neighborID]];
-                            vec3 neighborVelocity  = velocity[velocityIDs[neighborID]].xyz;
-
-                            // Pressure
-                            float pressureTerm = (currentPointPressure / (currentPointDensity*currentPointDensity)) +
-                                (neighborPressure / (neighborDensity*neighborDensity));
-                            pressureForce += -neighborMass * pressureTerm * CubicSplineGradient(dist, radius);
-
-                            // Viscosity
-                            viscosityForce += neighborMass * (neighborDensity * (neighborVelocity - currentPointVelocity)) * CubicSplineLaplacian(radius);
-
-                            // Gravity
-                            float distSoft = radiusSquared + softeningSquared;
-                            float denominator = sqrt(distSoft*distSoft*distSoft);
-                            gravityForce += uG * neighborMass * dist / denominator;
-                        }
+                uint end = ranges[2u * targetBucketKey + 1u];
+                for(uint tileStart = ranges[2u * targetBucketKey]; tileStart < end; tileStart += gl_WorkGroupSize.x) {
+                    uint slot = tileStart + localID;
+                    if(slot < end) {
+                        uint neighborID = sortedIDs[slot];
+                        tilePositions[localID]  = sortedPositions[slot];
+                        tileVelocities[localID] = particles[neighborID].velocity;
+                        tileData[localID]       = ParticleData(neighborID);
+                    }
+                    barrier();
+
+                    uint tileSize = min(gl_WorkGroupSize.x, end - tileStart);
+                    for(uint i = 0u; i < tileSize; i++) {
+                        vec3 dist = pointPos - tilePositions[i].xyz;
+                        force += PairForce(dist, dot(dist, dist), pointData, pointVelocity,
+                            tileData[i], tileVelocities[i].xyz);
                     }
-                    neighborID = next[neighborID];
+                    barrier();
                 }
             }
         }
     }
 
-    return pressureForce + viscosityForce + gravityForce;
+    return force;
 }
 
+// One workgroup per key, the key's particles are taken a workgroup at a time.
+// Groups stride over the table when it has more keys than a dispatch allows
+void main() {
+    uint localID = gl_LocalInvocationID.x;
+
+    for(uint key = gl_WorkGroupID.x; key < HASH_SIZE; key += gl_NumWorkGroups.x) {
+        uint start = ranges[2u * key];
+        uint end   = ranges[2u * key + 1u];
+
+        for(uint chunkStart = start; chunkStart < end; chunkStart += gl_WorkGroupSize.x) {
+            uint slot   = chunkStart + localID;
+            bool active = slot < end;
+
+            // Idle invocations follow the first particle so they agree on the cell
+            uint currentID   = sortedIDs[active ? slot : chunkStart];
+            vec3 pointPos    = sortedPositions[active ? slot : chunkStart].xyz;
+            ivec3 centerCell = GridCell(pointPos);
+
+            if(localID == 0u) {
+                groupCell  = centerCell;
+                groupMixed = 0u;
+            }
+            barrier();
+            if(centerCell != groupCell) {
+                atomicOr(groupMixed, 1u);
+            }
+            barrier();
+            bool mixed = groupMixed != 0u;
+            barrier();
+
+            // Colliding cells share the key but not the neighbors, nothing to tile
+            vec3 force = vec3(0.0f);
+            if(mixed) {
+                force = active ? ComputeForce(currentID) : vec3(0.0f);
+            } else {
+                force = ComputeTiledForce(pointPos, particles[currentID].velocity.xyz, ParticleData(currentID), centerCell);
+            }
+
+            if(active) {
+                particles[currentID].force.xyz = force;
+            }
+        }
+    }
+}
+#else
 void main() {
     uint currentID = gl_GlobalInvocationID.x;
-    if(currentID >= denseIDs.length()) {
+    if(currentID >= particles.length()) {
         return;
     }
 
-    uint currentPointID = denseIDs[currentID];
-    vec3 particleForce = ComputeForce(currentPointID);
-    force[forceIDs[currentPointID]].xyz = particleForce;
-}
\ No newline at end of file
+    particles[currentID].force.xyz = ComputeForce(currentID);
+}
+#endif
@@ -0,0 +1,37 @@
+#version 450 core
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "../common/particle.glsl"
+
+layout(std430, binding = 1) buffer sortKeys     { uint keys[];          };
+layout(std430, binding = 2) buffer sortValues   { uint values[];        };
+
+// Uniforms
+uniform uint  uCount;
+uniform uint  uMortonBits;
+
+// Inserts two zero bits between each of the low 10 bits
+uint SpreadBits(uint x) {
+    x &= 0x000003FFu;
+    x = (x | (x << 16)) & 0x030000FFu;
+    x = (x | (x << 8))  & 0x0300F00Fu;
+    x = (x | (x << 4))  & 0x030C30C3u;
+    x = (x | (x << 2))  & 0x09249249u;
+    return x;
+}
+
+void main() {
+    uint currentID = gl_GlobalInvocationID.x;
+    if(currentID >= uCount) {
+        return;
+    }
+
+    vec3 position = particles[currentID].positionAndRadius.xyz;
+
+    // Same key as sapphire::MortonKey, cell coordinates wrap every 2^uMortonBits
+    uint mask = (1u << uMortonBits) - 1u;
+    uvec3 cell = uvec3(ivec3(floor(position / CELL_SIZE)) + int(1u << (uMortonBits - 1u))) & mask;
+
+    keys[currentID]   = SpreadBits(cell.x) | (SpreadBits(cell.y) << 1) | (SpreadBits(cell.z) << 2);
+    values[currentID] = currentID;
+}
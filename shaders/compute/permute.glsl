@@ -0,0 +1,22 @@
+#version 450 core
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+layout(std430, binding = 0) buffer sourceData      { uint source[];      };
+layout(std430, binding = 1) buffer destinationData { uint destination[]; };
+layout(std430, binding = 2) buffer sortedIndices   { uint order[];       };
+
+// Uniforms
+uniform uint uStride; // Words per particle
+uniform uint uCount;
+
+void main() {
+    uint currentID = gl_GlobalInvocationID.x;
+    if(currentID >= uCount) {
+        return;
+    }
+
+    uint sourceIndex = order[currentID];
+    for(uint i = 0u; i < uStride; i++) {
+        destination[currentID * uStride + i] = source[sourceIndex * uStride + i];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#version 450 core
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+const uint RADIX = 16; // 4 bits per pass
+
+layout(std430, binding = 0) buffer sourceKeys        { uint keysIn[];    };
+layout(std430, binding = 1) buffer sourceValues      { uint valuesIn[];  };
+layout(std430, binding = 2) buffer destinationKeys   { uint keysOut[];   };
+layout(std430, binding = 3) buffer destinationValues { uint valuesOut[]; };
+
+// Digit major, counts[digit * uGroupCount + group]
+layout(std430, binding = 4) buffer digitCounts       { uint counts[];    };
+
+// Uniforms
+uniform uint uStage; // 0 = histogram, 1 = exclusive scan (one workgroup), 2 = scatter
+uniform uint uShift;
+uniform uint uCount;
+uniform uint uGroupCount;
+
+shared uint sharedData[gl_WorkGroupSize.x];
+
+void Histogram() {
+    uint currentID = gl_GlobalInvocationID.x;
+    uint localID   = gl_LocalInvocationID.x;
+
+    if(localID < RADIX) {
+        sharedData[localID] = 0u;
+    }
+    barrier();
+
+    if(currentID < uCount) {
+        atomicAdd(sharedData[(keysIn[currentID] >> uShift) & (RADIX - 1u)], 1u);
+    }
+    barrier();
+
+    if(localID < RADIX) {
+        counts[localID * uGroupCount + gl_WorkGroupID.x] = sharedData[localID];
+    }
+}
+
+void Scan() {
+    uint localID = gl_LocalInvocationID.x;
+    uint total   = RADIX * uGroupCount;
+    uint segment = (total + gl_WorkGroupSize.x - 1u) / gl_WorkGroupSize.x;
+    uint begin   = min(localID * segment, total);
+    uint end     = min(begin + segment, total);
+
+    uint sum = 0u;
+    for(uint i = begin; i < end; i++) {
+        sum += counts[i];
+    }
+    sharedData[localID] = sum;
+    barrier();
+
+    if(localID == 0u) {
+        uint offset = 0u;
+        for(uint i = 0u; i < gl_WorkGroupSize.x; i++) {
+            uint count = sharedData[i];
+            sharedData[i] = offset;
+            offset += count;
+        }
+    }
+    barrier();
+
+    uint offset = sharedData[localID];
+    for(uint i = begin; i < end; i++) {
+        uint count = counts[i];
+        counts[i] = offset;
+        offset += count;
+    }
+}
+
+void Scatter() {
+    uint currentID = gl_GlobalInvocationID.x;
+    uint localID   = gl_LocalInvocationID.x;
+
+    uint key   = currentID < uCount ? keysIn[currentID] : 0u;
+    uint digit = currentID < uCount ? (key >> uShift) & (RADIX - 1u) : RADIX;
+
+    sharedData[localID] = digit;
+    barrier();
+
+    if(currentID >= uCount) {
+        return;
+    }
+
+    // Rank among earlier invocations with the same digit keeps the sort stable
+    uint rank = 0u;
+    for(uint i = 0u; i < localID; i++) {
+        rank += sharedData[i] == digit ? 1u : 0u;
+    }
+
+    uint destination = counts[digit * uGroupCount + gl_WorkGroupID.x] + rank;
+    keysOut[destination]   = key;
+    valuesOut[destination] = valuesIn[currentID];
+}
+
+void main() {
+    if(uStage == 0u) {
+        Histogram();
+    } else if(uStage == 1u) {
+        Scan();
+    } else {
+        Scatter();
+    }
+}
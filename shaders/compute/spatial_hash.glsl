@@ -1,39 +1,78 @@
 #version 450 core
-layout(local_size_x = 64) in;
+layout(local_size_x = WORKGROUP_SIZE) in;
 
-layout(std430, binding = 0) buffer sphereComponent    { vec4 positionAndRadius[]; };
-layout(std430, binding = 1) buffer hashTable          { uint bucketHeads[];       };
-layout(std430, binding = 2) buffer nextPointers       { uint next[];              };
-layout(std430, binding = 3) buffer bucketKeys         { uint keys[];              };
+#include "../common/simulation_buffers.glsl"
+#include "../common/hash.glsl"
 
-layout(std430, binding = 4) buffer sphereComponentLoc { uint sphereIDs[];         };
+// Uniforms
+uniform uint uStage; // 0 = count, 1 = exclusive scan (one workgroup), 2 = scatter
 
-layout(std430, binding = 5) buffer denseSphereIDs     { uint denseIDs[];          };
+shared uint sharedData[gl_WorkGroupSize.x];
 
-// Uniforms
-uniform float uCellSize;
-uniform uint uHashSize;
 
+void Count() {
+    uint currentID = gl_GlobalInvocationID.x;
+    if(currentID >= particles.length()) {
+        return;
+    }
+
+    vec3 position = particles[currentID].positionAndRadius.xyz;
+    uint bucketKey = HashFunction(GridCell(position));
 
-uint HashFunction(ivec3 gridCell) {
-    const uint p1 = 73856093, p2 = 19349663, p3 = 83492791;
-    return (gridCell.x * p1 ^ gridCell.y * p2 ^ gridCell.z * p3) & (uHashSize - 1);
+    keys[currentID]  = bucketKey;
+    ranks[currentID] = atomicAdd(ranges[2u * bucketKey + 1u], 1u);
 }
 
-void main() {
+void Scan() {
+    uint localID = gl_LocalInvocationID.x;
+    uint segment = (HASH_SIZE + gl_WorkGroupSize.x - 1u) / gl_WorkGroupSize.x;
+    uint begin   = min(localID * segment, HASH_SIZE);
+    uint end     = min(begin + segment, HASH_SIZE);
+
+    uint sum = 0u;
+    for(uint i = begin; i < end; i++) {
+        sum += ranges[2u * i + 1u];
+    }
+    sharedData[localID] = sum;
+    barrier();
+
+    if(localID == 0u) {
+        uint offset = 0u;
+        for(uint i = 0u; i < gl_WorkGroupSize.x; i++) {
+            uint count = sharedData[i];
+            sharedData[i] = offset;
+            offset += count;
+        }
+    }
+    barrier();
+
+    uint offset = sharedData[localID];
+    for(uint i = begin; i < end; i++) {
+        uint count = ranges[2u * i + 1u];
+        ranges[2u * i]      = offset;
+        ranges[2u * i + 1u] = offset + count;
+        offset += count;
+    }
+}
+
+void Scatter() {
     uint currentID = gl_GlobalInvocationID.x;
-    if(currentID >= denseIDs.length()) {
+    if(currentID >= particles.length()) {
         return;
     }
 
-    uint currentPointID = denseIDs[currentID];
+    uint slot = ranges[2u * keys[currentID]] + ranks[currentID];
 
-    vec3 position = positionAndRadius[sphereIDs[currentPointID]].xyz;
-    ivec3 gridCell = ivec3(floor(position / uCellSize));
-    uint bucketKey = HashFunction(gridCell);
-
-    uint previousHead = atomicExchange(bucketHeads[bucketKey], currentPointID);
+    sortedIDs[slot]       = currentID;
+    sortedPositions[slot] = particles[currentID].positionAndRadius;
+}
 
-    next[currentPointID] = previousHead;
-    keys[currentPointID] = bucketKey;
-}
\ No newline at end of file
+void main() {
+    if(uStage == 0u) {
+        Count();
+    } else if(uStage == 1u) {
+        Scan();
+    } else {
+        Scatter();
+    }
+}
@@ -0,0 +1,56 @@
+#version 450 core
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "../common/simulation_buffers.glsl"
+#include "../common/parameters.glsl"
+
+// Uniforms
+uniform uint  uFinalize; // 0 = reduce maxima, 1 = single invocation computing dt
+
+void Finalize() {
+    float dt = uTimeStep;
+
+    if(ADAPTIVE_TIME_STEP != 0) {
+        // The criteria are written for h, SMOOTHING_LENGTH is the support radius
+        const float h = SMOOTHING_LENGTH / KERNEL_SUPPORT;
+
+        float maxSpeed        = uintBitsToFloat(maxSpeedBits);
+        float maxAcceleration = uintBitsToFloat(maxAccelerationBits);
+
+        dt = uCflFactor * h / (uSoundSpeed + maxSpeed);
+        if(maxAcceleration > 0.0f) {
+            dt = min(dt, uForceFactor * sqrt(h / maxAcceleration));
+        }
+        if(uViscosity > 0.0f) {
+            dt = min(dt, uViscosityFactor * h * h / uViscosity);
+        }
+        dt = clamp(dt, uMinTimeStep, uMaxTimeStep);
+    }
+
+    timeStep        = dt;
+    simulationTime += dt;
+
+    maxSpeedBits        = 0u;
+    maxAccelerationBits = 0u;
+}
+
+void main() {
+    uint currentID = gl_GlobalInvocationID.x;
+
+    if(uFinalize != 0u) {
+        if(currentID == 0u) {
+            Finalize();
+        }
+        return;
+    }
+
+    if(currentID >= particles.length()) {
+        return;
+    }
+
+    float speed        = length(particles[currentID].velocity.xyz);
+    float acceleration = length(particles[currentID].force.xyz / particles[currentID].mass);
+
+    atomicMax(maxSpeedBits,        floatBitsToUint(speed));
+    atomicMax(maxAccelerationBits, floatBitsToUint(acceleration));
+}
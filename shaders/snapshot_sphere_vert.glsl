@@ -0,0 +1,15 @@
+#version 450 core
+
+layout(std430, binding = 0) buffer particleSnapshot { vec4 positionAndRadius[]; };
+
+uniform mat4 uProjectionMatrix;
+uniform vec3 uCameraPosition;
+
+void main() {
+    vec4 currentPoint = positionAndRadius[gl_VertexID];
+
+    float dist = length(currentPoint.xyz - uCameraPosition);
+
+    gl_PointSize = currentPoint.w * 100.0f / dist;
+    gl_Position = uProjectionMatrix * vec4(currentPoint.xyz, 1.0f);
+}
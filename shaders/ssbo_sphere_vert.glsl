@@ -1,15 +1,15 @@
 #version 450 core
 
-layout(std430, binding = 0) buffer sphereComponent    { vec4 positionAndRadius[]; };
-layout(std430, binding = 1) buffer sphereComponentLoc { uint sphereIDs[];    };
-layout(std430, binding = 2) buffer denseSphereIDs     { uint denseIDs[];     };
+#include "common/particle.glsl"
+
+layout(std430, binding = 1) buffer previousSphere { vec4 previousPositionAndRadius[]; };
 
 uniform mat4 uProjectionMatrix;
 uniform vec3 uCameraPosition;
+uniform float uAlpha; // Interpolation between the last two simulation steps
 
 void main() {
-    uint currentPointID = denseIDs[gl_VertexID];
-    vec4 currentPoint = positionAndRadius[sphereIDs[currentPointID]];
+    vec4 currentPoint = mix(previousPositionAndRadius[gl_VertexID], particles[gl_VertexID].positionAndRadius, uAlpha);
 
     float dist = length(currentPoint.xyz - uCameraPosition);
 
@@ -0,0 +1,94 @@
+// C++ standard libraries
+#include <algorithm>
+#include <string>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+// Own libraries
+#include "quartz/core/utils/task_pool.hpp"
+#include "quartz/core/utils/numa_topology.hpp"
+#include "sapphire/application/headless_app.hpp"
+#ifdef __unix__
+#include "sapphire/distributed/unix_socket_transport.hpp"
+#endif
+
+// sph_headless [scene.json] [--steps N] [--output DIR] [--threads N] [--processes N] [--numa]
+int main(int argc, char* argv[]) {
+    std::string scenePath = "./config/scenes/default.json";
+    int steps   = -1;
+    int threads = -1;
+    int processes = 1;
+    bool numa = false;
+    std::string outputDirectory;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        try {
+            if(arg == "--steps" && hasValue) {
+                steps = std::stoi(argv[++i]);
+            } else if(arg == "--output" && hasValue) {
+                outputDirectory = argv[++i];
+            } else if(arg == "--threads" && hasValue) {
+                threads = std::stoi(argv[++i]);
+            } else if(arg == "--processes" && hasValue) {
+                processes = std::stoi(argv[++i]);
+            } else if(arg == "--numa") {
+                numa = true;
+            } else if(arg.starts_with("--")) {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                return 1;
+            } else {
+                scenePath = arg;
+            }
+        } catch(const std::invalid_argument&) {
+            std::cerr << "Invalid number for " << arg << ": " << argv[i] << std::endl;
+            return 1;
+        } catch(const std::out_of_range&) {
+            std::cerr << "Number out of range for " << arg << ": " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    // Forked before any worker thread exists, the cores are shared between the processes
+    std::shared_ptr<ITransport> transport;
+    if(processes > 1) {
+#ifdef __unix__
+        transport = UnixSocketTransport::Launch(processes);
+#else
+        std::cerr << "--processes needs a Unix system" << std::endl;
+        return 1;
+#endif
+        if(threads <= 0 && !numa) {
+            threads = std::max(1u, std::thread::hardware_concurrency() / processes);
+        }
+    }
+
+    // Workers pinned node after node, every process on its own slice of the machine
+    if(numa) {
+        const int rank = transport ? transport->GetRank() : 0;
+        const auto cpus = quartz::NumaTopology::Get().GetCpuShare(rank, processes);
+        quartz::TaskPool::SetDefaultCpus(cpus);
+        if(threads <= 0) {
+            threads = cpus.size();
+        }
+    }
+
+    if(threads > 0) {
+        quartz::TaskPool::SetDefaultThreadCount(threads);
+    }
+
+    HeadlessApp app(scenePath, transport);
+    if(steps >= 0) {
+        app.SetSteps(steps);
+    }
+    if(!outputDirectory.empty()) {
+        app.SetOutputDirectory(outputDirectory);
+    }
+    app.Run();
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "quartz/core/utils/numa_topology.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Third_party libraries
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    // sysfs cpulist format, e.g. "0-3,8-11"
+    std::vector<unsigned int> ParseCpuList(const std::string& list) {
+        std::vector<unsigned int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+
+        while(std::getline(stream, range, ',')) {
+            if(range.empty() || range == "\n") {
+                continue;
+            }
+            const size_t dash = range.find('-');
+            const unsigned int first = std::stoul(range.substr(0, dash));
+            const unsigned int last  = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+            for(unsigned int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    bool IsAllowed(unsigned int cpu) {
+#ifdef __linux__
+        static cpu_set_t allowed;
+        static const bool known = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        return !known || cpu >= CPU_SETSIZE || CPU_ISSET(cpu, &allowed);
+#else
+        return true;
+#endif
+    }
+}
+
+quartz::NumaTopology::NumaTopology() {
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    const fs::path nodeRoot = "/sys/devices/system/node";
+    if(fs::is_directory(nodeRoot, error)) {
+        std::vector<std::pair<unsigned int, std::vector<unsigned int>>> nodes;
+
+        for(const auto& entry : fs::directory_iterator(nodeRoot, error)) {
+            const std::string name = entry.path().filename().string();
+            if(!name.starts_with("node") || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+                continue;
+            }
+
+            std::ifstream file(entry.path() / "cpulist");
+            std::string list;
+            std::getline(file, list);
+
+            std::vector<unsigned int> cpus = ParseCpuList(list);
+            std::erase_if(cpus, [](unsigned int cpu) { return !IsAllowed(cpu); });
+            if(!cpus.empty()) {
+                nodes.emplace_back(std::stoul(name.substr(4)), std::move(cpus));
+            }
+        }
+
+        std::sort(nodes.begin(), nodes.end());
+        for(auto& node : nodes) {
+            mNodeCpus.push_back(std::move(node.second));
+        }
+    }
+
+    if(mNodeCpus.empty()) {
+        std::vector<unsigned int> cpus;
+        for(unsigned int cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); cpu++) {
+            cpus.push_back(cpu);
+        }
+        mNodeCpus.push_back(std::move(cpus));
+    }
+}
+
+const quartz::NumaTopology& quartz::NumaTopology::Get() {
+    static NumaTopology topology;
+    return topology;
+}
+
+size_t quartz::NumaTopology::GetNodeCount() const {
+    return mNodeCpus.size();
+}
+const std::vector<unsigned int>& quartz::NumaTopology::GetNodeCpus(size_t node) const {
+    return mNodeCpus[node];
+}
+
+std::vector<unsigned int> quartz::NumaTopology::GetCpus() const {
+    std::vector<unsigned int> cpus;
+    for(const auto& node : mNodeCpus) {
+        cpus.insert(cpus.end(), node.begin(), node.end());
+    }
+    return cpus;
+}
+
+std::vector<unsigned int> quartz::NumaTopology::GetCpuShare(unsigned int share, unsigned int shareCount) const {
+    const std::vector<unsigned int> cpus = GetCpus();
+    shareCount = std::max(shareCount, 1u);
+
+    const size_t first = cpus.size() * share / shareCount;
+    const size_t last  = cpus.size() * (share + 1) / shareCount;
+    if(first == last) {
+        // More shares than cpus, shares wrap around
+        return {cpus[share % cpus.size()]};
+    }
+    return std::vector<unsigned int>(cpus.begin() + first, cpus.begin() + last);
+}
+
+size_t quartz::NumaTopology::GetNodeOfCpu(unsigned int cpu) const {
+    for(size_t node = 0; node < mNodeCpus.size(); node++) {
+        if(std::find(mNodeCpus[node].begin(), mNodeCpus[node].end(), cpu) != mNodeCpus[node].end()) {
+            return node;
+        }
+    }
+    return 0;
+}
+
+bool quartz::NumaTopology::PinThread(unsigned int cpu) {
+#ifdef __linux__
+    if(cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
@@ -0,0 +1,268 @@
+#include "quartz/core/utils/task_pool.hpp"
+#include "quartz/core/utils/numa_topology.hpp"
+
+namespace {
+    unsigned int gDefaultThreadCount = 0;
+    std::vector<unsigned int> gDefaultCpus;
+
+    // Set while this thread runs a loop body, nested loops must not wait on the pool
+    thread_local bool tInsideJob = false;
+
+    struct InsideJobScope {
+        bool previous = tInsideJob;
+        InsideJobScope()  { tInsideJob = true; }
+        ~InsideJobScope() { tInsideJob = previous; }
+    };
+}
+
+quartz::TaskPool::TaskPool(unsigned int threadCount, const std::vector<unsigned int>& cpus) {
+    threadCount = std::max(threadCount, 1u);
+
+    std::vector<int> workerCpus(threadCount, -1);
+    std::vector<size_t> workerNodes(threadCount, 0);
+    if(!cpus.empty()) {
+        const auto& topology = NumaTopology::Get();
+        for(unsigned int i = 0; i < threadCount; i++) {
+            workerCpus[i]  = cpus[size_t(i) * cpus.size() / threadCount];
+            workerNodes[i] = topology.GetNodeOfCpu(workerCpus[i]);
+        }
+        // The calling thread is worker 0, a refusal leaves the pool unpinned but working
+        mPinned = NumaTopology::PinThread(workerCpus[0]);
+    }
+
+    for(unsigned int i = 0; i < threadCount; i++) {
+        mQueues.push_back(std::make_unique<WorkerQueue>());
+
+        std::vector<unsigned int> victims;
+        for(unsigned int offset = 1; offset < threadCount; offset++) {
+            victims.push_back((i + offset) % threadCount);
+        }
+        std::stable_partition(victims.begin(), victims.end(), [&](unsigned int victim) {
+            return workerNodes[victim] == workerNodes[i];
+        });
+        mStealOrder.push_back(std::move(victims));
+    }
+
+    for(unsigned int i = 1; i < threadCount; i++) {
+        mThreads.emplace_back(&TaskPool::WorkerLoop, this, i, mPinned ? workerCpus[i] : -1);
+    }
+}
+
+quartz::TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStop = true;
+    }
+    mWakeUp.notify_all();
+
+    for(auto& thread : mThreads) {
+        thread.join();
+    }
+}
+
+quartz::TaskPool& quartz::TaskPool::Get() {
+    static TaskPool pool(gDefaultThreadCount > 0 ? gDefaultThreadCount : std::thread::hardware_concurrency(), gDefaultCpus);
+    return pool;
+}
+
+void quartz::TaskPool::SetDefaultThreadCount(unsigned int threadCount) {
+    gDefaultThreadCount = threadCount;
+}
+
+void quartz::TaskPool::SetDefaultCpus(const std::vector<unsigned int>& cpus) {
+    gDefaultCpus = cpus;
+}
+
+void quartz::TaskPool::ParallelFor(size_t begin, size_t end, size_t grainSize, const RangeFunction& body) {
+    if(begin >= end) {
+        return;
+    }
+
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    std::vector<Chunk> chunks;
+    chunks.reserve((end - begin + grainSize - 1) / grainSize);
+    for(size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize) {
+        chunks.push_back({chunkBegin, std::min(chunkBegin + grainSize, end), nullptr});
+    }
+
+    Job job{&body, chunks.size()};
+    Run(job, chunks);
+}
+
+void quartz::TaskPool::ParallelFor(size_t begin, size_t end, const RangeFunction& body) {
+    const size_t chunkCount = GetThreadCount() * CHUNKS_PER_THREAD;
+    ParallelFor(begin, end, (end - begin + chunkCount - 1) / chunkCount, body);
+}
+
+void quartz::TaskPool::ParallelForWeighted(const std::vector<uint32_t>& costs, const RangeFunction& body) {
+    if(costs.empty()) {
+        return;
+    }
+
+    size_t totalCost = 0;
+    for(const auto& cost : costs) {
+        totalCost += cost + 1; // +1 so zero cost items still get spread out
+    }
+
+    const size_t chunkCount = GetThreadCount() * CHUNKS_PER_THREAD;
+    const size_t targetCost = std::max<size_t>(totalCost / chunkCount, 1);
+
+    std::vector<Chunk> chunks;
+    chunks.reserve(chunkCount + 1);
+
+    size_t chunkBegin = 0;
+    size_t chunkCost  = 0;
+    for(size_t i = 0; i < costs.size(); i++) {
+        chunkCost += costs[i] + 1;
+        if(chunkCost >= targetCost) {
+            chunks.push_back({chunkBegin, i + 1, nullptr});
+            chunkBegin = i + 1;
+            chunkCost  = 0;
+        }
+    }
+    if(chunkBegin < costs.size()) {
+        chunks.push_back({chunkBegin, costs.size(), nullptr});
+    }
+
+    Job job{&body, chunks.size()};
+    Run(job, chunks);
+}
+
+unsigned int quartz::TaskPool::GetThreadCount() const noexcept {
+    return mQueues.size();
+}
+
+bool quartz::TaskPool::IsPinned() const noexcept {
+    return mPinned;
+}
+
+
+// Private
+void quartz::TaskPool::Run(Job& job, const std::vector<Chunk>& chunks) {
+    // Nested loop, the pool is busy with the outer one and may be waiting on this thread
+    if(tInsideJob) {
+        for(const auto& chunk : chunks) {
+            (*job.body)(chunk.begin, chunk.end);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(mRunMutex);
+
+    // Serial fallback, no point waking anyone
+    if(mThreads.empty() || chunks.size() == 1) {
+        InsideJobScope scope;
+        for(const auto& chunk : chunks) {
+            (*job.body)(chunk.begin, chunk.end);
+        }
+        return;
+    }
+
+    // Contiguous blocks of chunks per worker
+    const size_t workerCount = mQueues.size();
+    for(size_t worker = 0; worker < workerCount; worker++) {
+        const size_t first = chunks.size() * worker / workerCount;
+        const size_t last  = chunks.size() * (worker + 1) / workerCount;
+
+        std::lock_guard<std::mutex> lock(mQueues[worker]->mutex);
+        for(size_t i = first; i < last; i++) {
+            mQueues[worker]->chunks.push_back({chunks[i].begin, chunks[i].end, &job});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mPendingChunks += chunks.size();
+    }
+    mWakeUp.notify_all();
+
+    // Calling thread works as worker 0
+    Chunk chunk;
+    while(job.remaining.load(std::memory_order_acquire) > 0) {
+        if(TryPop(0, chunk) || TrySteal(0, chunk)) {
+            Execute(chunk);
+            continue;
+        }
+
+        // Nothing left to grab, wait for the last chunks still running elsewhere
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mJobDone.wait(lock, [&job]() { return job.remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+    if(job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void quartz::TaskPool::WorkerLoop(unsigned int workerIndex, int cpu) {
+    if(cpu >= 0) {
+        NumaTopology::PinThread(cpu);
+    }
+
+    Chunk chunk;
+
+    while(true) {
+        if(TryPop(workerIndex, chunk) || TrySteal(workerIndex, chunk)) {
+            Execute(chunk);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeUp.wait(lock, [this]() { return mStop || mPendingChunks.load() > 0; });
+        if(mStop) {
+            return;
+        }
+    }
+}
+
+bool quartz::TaskPool::TryPop(unsigned int workerIndex, Chunk& chunk) {
+    auto& queue = *mQueues[workerIndex];
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.chunks.empty()) {
+        return false;
+    }
+
+    chunk = queue.chunks.back();
+    queue.chunks.pop_back();
+    mPendingChunks--;
+    return true;
+}
+
+bool quartz::TaskPool::TrySteal(unsigned int workerIndex, Chunk& chunk) {
+    for(const auto& victimIndex : mStealOrder[workerIndex]) {
+        auto& victim = *mQueues[victimIndex];
+
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(victim.chunks.empty()) {
+            continue;
+        }
+
+        chunk = victim.chunks.front();
+        victim.chunks.pop_front();
+        mPendingChunks--;
+        return true;
+    }
+
+    return false;
+}
+
+void quartz::TaskPool::Execute(const Chunk& chunk) {
+    if(!chunk.job->failed.load(std::memory_order_relaxed)) {
+        InsideJobScope scope;
+        try {
+            (*chunk.job->body)(chunk.begin, chunk.end);
+        } catch(...) {
+            // Published to the caller by the release below, remaining only reaches zero after it
+            if(!chunk.job->failed.exchange(true)) {
+                chunk.job->error = std::current_exception();
+            }
+        }
+    }
+
+    if(chunk.job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mJobDone.notify_all();
+    }
+}
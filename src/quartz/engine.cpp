@@ -1,4 +1,5 @@
 #include "./quartz/engine.hpp"
+#include "./quartz/graphics/shader.hpp"
 
 quartz::Engine::~Engine() {
     Shutdown();
@@ -68,10 +69,27 @@ void quartz::Engine::Initialize(const std::string& configPath) {
         SDL_GL_SetSwapInterval(0);
     }
 
+    // Programs load from disk instead of compiling once cached
+    shader::SetProgramCacheDirectory(config["rendering"].value("shader_cache", ""));
+
+    if(config.contains("simulation")) {
+        float stepRate  = config["simulation"].value("step_rate", 0.0f);
+        int maxSubsteps = config["simulation"].value("max_substeps", 1);
+
+        SetFixedTimeStep(stepRate > 0.0f ? 1.0f / stepRate : 0.0f, maxSubsteps);
+        SetThreadedSimulation(config["simulation"].value("threaded", false));
+    }
+
 }
 
 void quartz::Engine::Run() {
     
+    mLastTime = SDL_GetPerformanceCounter();
+
+    if(mThreadedSimulation && mFixedUpdateCallback) {
+        mSimulationThread = std::thread(&Engine::SimulationLoop, this);
+    }
+
     while (!mQuit) {
         Uint64 now = SDL_GetPerformanceCounter();
         float deltaTime = (now - mLastTime) / float(SDL_GetPerformanceFrequency());
@@ -79,6 +97,10 @@ void quartz::Engine::Run() {
         
         mEventCallback(deltaTime);
 
+        if(!mThreadedSimulation) {
+            RunFixedUpdates(deltaTime);
+        }
+
         glEnable(GL_DEPTH_TEST);
         glEnable(GL_CULL_FACE);
         glEnable(GL_PROGRAM_POINT_SIZE);
@@ -95,9 +117,75 @@ void quartz::Engine::Run() {
         SDL_GL_SwapWindow(mWindow);
 
     }
+
+    if(mSimulationThread.joinable()) {
+        mSimulationThread.join();
+    }
+}
+
+void quartz::Engine::RunFixedUpdates(float deltaTime) {
+    if(!mFixedUpdateCallback) {
+        return;
+    }
+
+    if(mFixedStep <= 0.0f) {
+        mFixedUpdateCallback(deltaTime);
+        mInterpolationAlpha = 1.0f;
+        return;
+    }
+
+    mAccumulator += deltaTime;
+
+    int substeps = 0;
+    while(mAccumulator >= mFixedStep && substeps < mMaxSubsteps) {
+        mFixedUpdateCallback(mFixedStep);
+        mAccumulator -= mFixedStep;
+        substeps++;
+    }
+
+    // Over budget, drop the backlog instead of spiralling further behind
+    if(mAccumulator >= mFixedStep) {
+        mAccumulator = std::fmod(mAccumulator, mFixedStep);
+    }
+
+    mInterpolationAlpha = mAccumulator / mFixedStep;
+}
+
+void quartz::Engine::SimulationLoop() {
+    using Clock = std::chrono::steady_clock;
+
+    auto lastTime = Clock::now();
+    auto nextStep = lastTime;
+
+    while(!mQuit) {
+        if(mFixedStep <= 0.0f) {
+            auto now = Clock::now();
+            mFixedUpdateCallback(std::chrono::duration<float>(now - lastTime).count());
+            lastTime = now;
+            continue;
+        }
+
+        auto fixedStep = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(mFixedStep));
+
+        mFixedUpdateCallback(mFixedStep);
+        nextStep += fixedStep;
+
+        auto now = Clock::now();
+        if(now < nextStep) {
+            std::this_thread::sleep_until(nextStep);
+        } else if(now - nextStep > fixedStep * mMaxSubsteps) {
+            // Too far behind, drop the backlog
+            nextStep = now;
+        }
+    }
 }
 
 void quartz::Engine::Shutdown() {
+    mQuit = true;
+    if(mSimulationThread.joinable()) {
+        mSimulationThread.join();
+    }
+
     SDL_DestroyWindow(mWindow);
     mWindow = nullptr;
 
@@ -116,4 +204,24 @@ void quartz::Engine::SetUpdateCallback(const std::function<void(float)>& func) {
 }
 void quartz::Engine::SetSystemCallback(const std::function<void(float)>& func) {
     mSystemCallback = func;
+}
+void quartz::Engine::SetFixedUpdateCallback(const std::function<void(float)>& func) {
+    mFixedUpdateCallback = func;
+}
+
+void quartz::Engine::SetFixedTimeStep(float fixedStep, int maxSubsteps) {
+    mFixedStep   = fixedStep;
+    mMaxSubsteps = std::max(maxSubsteps, 1);
+    mAccumulator = 0.0f;
+}
+
+float quartz::Engine::GetInterpolationAlpha() const {
+    return mInterpolationAlpha;
+}
+
+void quartz::Engine::SetThreadedSimulation(bool threaded) {
+    mThreadedSimulation = threaded;
+}
+bool quartz::Engine::IsSimulationThreaded() const {
+    return mThreadedSimulation;
 }
\ No newline at end of file
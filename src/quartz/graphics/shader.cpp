@@ -1,49 +1,269 @@
 #include "./quartz/graphics/shader.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <format>
 #include <vector>
 namespace {
-    std::string LoadShaderAsString(const std::string& src) {
-        std::string result = "";
+    std::string gProgramCacheDirectory;
 
-        std::string line = "";
-        std::ifstream myFile(src.c_str());
+    struct ProgramStage {
+        GLuint type;
+        std::string code = "";
+        std::vector<std::string> files = {}; // Source string numbers used by #line, the shader itself first
+    };
 
-        if(myFile.is_open()) {
-            while(std::getline(myFile, line)) {
-                result += line + "\n";
+    // Pastes #include "file" lines in place, paths are relative to the including file.
+    // Every file is included once, #line numbers errors by file index and line.
+    bool ExpandIncludes(const std::filesystem::path& path, std::string& output, std::vector<std::string>& files) {
+        std::ifstream file(path);
+        if(!file) {
+            return false;
+        }
+
+        const std::string fileIndex = std::to_string(files.size());
+        files.push_back(path.generic_string());
+
+        std::string line;
+        int lineNumber = 0;
+        while(std::getline(file, line)) {
+            lineNumber++;
+
+            size_t directive = line.find_first_not_of(" \t");
+            if(directive == std::string::npos || line.compare(directive, 8, "#include") != 0) {
+                output += line + "\n";
+                continue;
+            }
+
+            size_t open  = line.find('"', directive);
+            size_t close = line.find('"', open + 1);
+            if(open == std::string::npos || close == std::string::npos) {
+                std::cerr << "SHADER INCLUDE ERROR (" << path.generic_string() << ":" << lineNumber << "): expected #include \"file\"" << std::endl;
+                return false;
+            }
+
+            std::filesystem::path includePath = path.parent_path() / line.substr(open + 1, close - open - 1);
+            includePath = includePath.lexically_normal();
+
+            bool included = false;
+            for(const std::string& includedFile : files) {
+                included = included || includedFile == includePath.generic_string();
+            }
+            if(included) {
+                output += "\n";
+                continue;
+            }
+
+            output += "#line 1 " + std::to_string(files.size()) + "\n";
+            if(!ExpandIncludes(includePath, output, files)) {
+                std::cerr << "SHADER INCLUDE ERROR (" << path.generic_string() << ":" << lineNumber << "): could not read " << includePath.generic_string() << std::endl;
+                return false;
             }
-            myFile.close();
+            output += "#line " + std::to_string(lineNumber + 1) + " " + fileIndex + "\n";
         }
 
-        return result;
+        return true;
     }
-}
 
-GLuint shader::CompileShader(GLuint type, const std::string& shaderPath) {
-    GLuint shaderObject;
+    std::string LoadShaderSource(
+        const std::string& shaderPath,
+        const shader::Defines& defines,
+        const std::string& prelude,
+        std::vector<std::string>& files
+    ) {
+        std::string shaderCode;
+        if(!ExpandIncludes(std::filesystem::path(shaderPath).lexically_normal(), shaderCode, files)) {
+            if(files.empty()) {
+                std::cerr << "SHADER LOAD ERROR (" << shaderPath << "): could not read the file" << std::endl;
+            }
+            return "";
+        }
+        if(defines.empty() && prelude.empty()) {
+            return shaderCode;
+        }
 
-    shaderObject = glCreateShader(type);
+        std::string header;
+        for(const auto& [name, value] : defines) {
+            header += "#define " + name + " " + value + "\n";
+        }
+        header += prelude;
 
-    std::string shaderCode = LoadShaderAsString(shaderPath);
-    
-    const char* src = shaderCode.c_str();
-    glShaderSource(shaderObject, 1, &src, nullptr);
-    glCompileShader(shaderObject);
+        // #version has to stay the first line, #line keeps error lines matching the file
+        size_t versionEnd = shaderCode.find('\n', shaderCode.find("#version"));
+        if(versionEnd == std::string::npos) {
+            std::cerr << "SHADER PRELUDE ERROR (" << shaderPath << "): no #version line" << std::endl;
+            return "";
+        }
+        shaderCode.insert(versionEnd + 1, header + "\n#line 2 0\n");
+        return shaderCode;
+    }
 
-    GLint success;
-    glGetShaderiv(shaderObject, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        GLint length;
-        glGetShaderiv(shaderObject, GL_INFO_LOG_LENGTH, &length);
-        std::vector<GLchar> log(length);
-        glGetShaderInfoLog(shaderObject, length, &length, log.data());
-        
-        std::cerr << "SHADER COMPILE ERROR (" << shaderPath << "):\n"
-                  << log.data() << std::endl;
-        return 0; // Return 0 to indicate failure
+    GLuint CompileSource(GLuint type, const std::string& shaderCode, const std::vector<std::string>& files) {
+        GLuint shaderObject = glCreateShader(type);
+
+        const char* src = shaderCode.c_str();
+        glShaderSource(shaderObject, 1, &src, nullptr);
+        glCompileShader(shaderObject);
+
+        GLint success;
+        glGetShaderiv(shaderObject, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLint length;
+            glGetShaderiv(shaderObject, GL_INFO_LOG_LENGTH, &length);
+            std::vector<GLchar> log(length);
+            glGetShaderInfoLog(shaderObject, length, &length, log.data());
+
+            std::cerr << "SHADER COMPILE ERROR (" << files.front() << "):\n"
+                      << log.data() << std::endl;
+            // Errors name files by the number #line gave them
+            for(size_t i = 1; i < files.size(); i++) {
+                std::cerr << "  " << i << " = " << files[i] << std::endl;
+            }
+            return 0; // Return 0 to indicate failure
+        }
+
+        return shaderObject;
+    }
+
+    // FNV-1a, only has to tell sources apart
+    uint64_t HashString(const std::string& text, uint64_t hash = 14695981039346656037ull) {
+        for(unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Binaries only load on the driver that produced them
+    std::string ProgramCachePath(const std::vector<ProgramStage>& stages) {
+        std::string driver;
+        for(GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            const GLubyte* value = glGetString(name);
+            driver += value ? reinterpret_cast<const char*>(value) : "";
+            driver += '\n';
+        }
+
+        uint64_t hash = HashString(driver);
+        for(const ProgramStage& stage : stages) {
+            hash = HashString(std::to_string(stage.type) + '\n' + stage.code, hash);
+        }
+
+        return std::format("{}/{:016x}.bin", gProgramCacheDirectory, hash);
+    }
+
+    bool CacheSupported() {
+        if(gProgramCacheDirectory.empty()) {
+            return false;
+        }
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
     }
 
-    return shaderObject;
+    // File holds the binary format followed by the binary
+    bool LoadProgramBinary(GLuint program, const std::string& cachePath) {
+        std::ifstream cacheFile(cachePath, std::ios::binary);
+        if(!cacheFile) {
+            return false;
+        }
+
+        GLenum format = 0;
+        if(!cacheFile.read(reinterpret_cast<char*>(&format), sizeof(format))) {
+            return false;
+        }
+        std::vector<char> binary((std::istreambuf_iterator<char>(cacheFile)), std::istreambuf_iterator<char>());
+        if(binary.empty()) {
+            return false;
+        }
+
+        glProgramBinary(program, format, binary.data(), binary.size());
+
+        // A driver update can reject binaries even with the same version string
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        return success;
+    }
+
+    void StoreProgramBinary(GLuint program, const std::string& cachePath) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if(length <= 0) {
+            return;
+        }
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+
+        std::error_code error;
+        std::filesystem::create_directories(gProgramCacheDirectory, error);
+
+        std::ofstream cacheFile(cachePath, std::ios::binary);
+        if(!cacheFile) {
+            std::cerr << "Could not write program cache: " << cachePath << std::endl;
+            return;
+        }
+        cacheFile.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        cacheFile.write(binary.data(), length);
+    }
+
+    GLuint CreateProgram(const std::vector<ProgramStage>& stages) {
+        GLuint programObject = glCreateProgram();
+
+        const bool useCache = CacheSupported();
+        std::string cachePath;
+        if(useCache) {
+            cachePath = ProgramCachePath(stages);
+            if(LoadProgramBinary(programObject, cachePath)) {
+                return programObject;
+            }
+            glProgramParameteri(programObject, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
+        std::vector<GLuint> shaders;
+        for(const ProgramStage& stage : stages) {
+            GLuint shaderObject = CompileSource(stage.type, stage.code, stage.files);
+            glAttachShader(programObject, shaderObject);
+            shaders.push_back(shaderObject);
+        }
+        glLinkProgram(programObject);
+
+        for(GLuint shaderObject : shaders) {
+            glDetachShader(programObject, shaderObject);
+            glDeleteShader(shaderObject);
+        }
+
+        GLint success;
+        glGetProgramiv(programObject, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLint length;
+            glGetProgramiv(programObject, GL_INFO_LOG_LENGTH, &length);
+            std::vector<GLchar> log(length);
+            glGetProgramInfoLog(programObject, length, &length, log.data());
 
+            std::cerr << "PROGRAM LINK ERROR (" << stages.front().files.front() << "):\n"
+                      << log.data() << std::endl;
+            return 0; // Return 0 to indicate failure
+        }
+
+        if(useCache) {
+            StoreProgramBinary(programObject, cachePath);
+        }
+
+        return programObject;
+    }
+}
+
+GLuint shader::CompileShader(GLuint type, const std::string& shaderPath) {
+    return CompileShader(type, shaderPath, "");
+}
+
+GLuint shader::CompileShader(GLuint type, const std::string& shaderPath, const std::string& prelude) {
+    std::vector<std::string> files;
+    std::string shaderCode = LoadShaderSource(shaderPath, {}, prelude, files);
+    if(shaderCode.empty()) {
+        return 0;
+    }
+    return CompileSource(type, shaderCode, files);
 }
 
 GLuint shader::LinkProgram(GLuint& shader) {
@@ -71,20 +291,43 @@ GLuint shader::LinkProgram(GLuint& shader) {
 }
 
 GLuint shader::CreateGraphicsPipeline(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) {
-    GLuint programObject = glCreateProgram();
-
-    GLuint myVertexShader =   shader::CompileShader(GL_VERTEX_SHADER, vertexShaderPath);
-    GLuint myFragmentShader = shader::CompileShader(GL_FRAGMENT_SHADER, fragmentShaderPath);
+    ProgramStage vertexStage{GL_VERTEX_SHADER};
+    ProgramStage fragmentStage{GL_FRAGMENT_SHADER};
+    vertexStage.code   = LoadShaderSource(vertexShaderPath, {}, "", vertexStage.files);
+    fragmentStage.code = LoadShaderSource(fragmentShaderPath, {}, "", fragmentStage.files);
+    if(vertexStage.code.empty() || fragmentStage.code.empty()) {
+        return 0;
+    }
 
-    glAttachShader(programObject, myVertexShader);
-    glAttachShader(programObject, myFragmentShader);
-    glLinkProgram(programObject);
+    GLuint programObject = CreateProgram({vertexStage, fragmentStage});
 
     glValidateProgram(programObject);
 
     return programObject;
 }
 
+GLuint shader::CreateComputeProgram(const std::string& shaderPath, const Defines& defines, const std::string& prelude) {
+    ProgramStage stage{GL_COMPUTE_SHADER};
+    stage.code = LoadShaderSource(shaderPath, defines, prelude, stage.files);
+    if(stage.code.empty()) {
+        return 0;
+    }
+    return CreateProgram({stage});
+}
+
+std::string shader::FloatLiteral(float value) {
+    std::string literal = std::format("{:.9g}", value);
+    // Without a point or exponent GLSL reads an int
+    if(literal.find_first_of(".en") == std::string::npos) {
+        literal += ".0";
+    }
+    return literal;
+}
+
+void shader::SetProgramCacheDirectory(const std::string& directory) {
+    gProgramCacheDirectory = directory;
+}
+
 int shader::FindUniformLocation(GLuint pipeline, const GLchar* name) {
     GLint uniformLocation = glGetUniformLocation(pipeline,name);
     if(uniformLocation < 0) {
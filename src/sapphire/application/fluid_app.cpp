@@ -1,6 +1,6 @@
 #include "sapphire/application/fluid_app.hpp"
 
-FluidApp::FluidApp(std::string configFilePath) : mWindowData(configFilePath), mParticleSystem(mRegistry) {
+FluidApp::FluidApp(std::string configFilePath) : mConfigFilePath(configFilePath), mWindowData(configFilePath), mParticleSystem(mRegistry) {
     mEngine.Initialize(configFilePath);
 
     // GLuint shaderProgram = shader::CreateGraphicsPipeline("./shaders/sphereVert.glsl", "./shaders/instancedFrag.glsl");
@@ -9,11 +9,18 @@ FluidApp::FluidApp(std::string configFilePath) : mWindowData(configFilePath), mP
     mEngine.SetEventCallback([this](float dt) {this->Event(dt);});
     mEngine.SetSystemCallback([this](float dt) {this->System(dt);});
     mEngine.SetUpdateCallback([this](float dt) {this->Loop(dt);});
+    mEngine.SetFixedUpdateCallback([this](float dt) {this->FixedUpdate(dt);});
 
     // Opengl Related
     InitEntities();
     
+    if(mEngine.IsSimulationThreaded()) {
+        mSnapshotRenderer = std::make_unique<SnapshotRenderSystem>();
+        return;
+    }
+
     mDataBuffers.Init(mRegistry);
+    mGPUSphereDataSystem = std::make_unique<GPUSphereDataSystem>(mRegistry);
 }
 FluidApp::~FluidApp() {
     mEngine.Shutdown();
@@ -26,19 +33,17 @@ void FluidApp::Run() {
 
 // Private
 void FluidApp::Loop(float deltaTime) {
+    UpdateDiagnostics();
     FpsCounter(deltaTime);
+    UpdateProfilerOverlay();
 }
 void FluidApp::System(float deltaTime) {
     static quartz::CameraSystem cameraSystem;
     static quartz::GuiCameraSystem guiCameraSystem;
-    static GPUSphereDataSystem gpuToSphereDataSystem(mRegistry);
     static quartz::UiRendererSystem uiRenderer;
     static quartz::ButtonSystem buttonSystem;
     static quartz::StyleSetupSystem styleSystem(mFontManager, mWindowData.mScreenWidth, mWindowData.mScreenHeight);
     static quartz::GuiVertexSetupSystem guiVertexSystem;
-    // static SphereDataSystem sphereDataSystem;
-    // static ForceToPosSystem forceToPosSystem;
-    // static PosToSpatialSystem posToSpatialSystem;
     
     styleSystem.Update(mRegistry);
     guiVertexSystem.Update(mRegistry);
@@ -46,16 +51,27 @@ void FluidApp::System(float deltaTime) {
     cameraSystem.Update(mRegistry);
     guiCameraSystem.Update(mRegistry);
     buttonSystem.Update(mRegistry);
-    // posToSpatialSystem.Update(mRegistry);
-    // sphereDataSystem.Update(mRegistry);
-    // forceToPosSystem.Update(mRegistry, deltaTime);
     
-    gpuToSphereDataSystem.Update(mRegistry, mDataBuffers);
+    if(mEngine.IsSimulationThreaded()) {
+        mSnapshotRenderer->Update(mRegistry, mCpuSimulation.GetSnapshots());
+    } else {
+        mGPUSphereDataSystem->Render(mRegistry, mDataBuffers, mEngine.GetInterpolationAlpha());
+    }
     
     uiRenderer.Update(mRegistry);
 
     // gInstanceRenderer.Update(mRegistry);
 }
+void FluidApp::FixedUpdate(float) {
+    if(mEngine.IsSimulationThreaded()) {
+        // Simulation thread, must not touch mRegistry or gl
+        mCpuSimulation.Step();
+        mCpuSimulation.PublishSnapshot();
+        return;
+    }
+
+    mGPUSphereDataSystem->Simulate(mRegistry, mDataBuffers);
+}
 void FluidApp::Event(float deltaTime) {
     auto& mouse = mRegistry.GetSingleton<MouseStateComponent>();
     // Reset
@@ -78,9 +94,13 @@ void FluidApp::Event(float deltaTime) {
                 int mouseX = e.button.x;
                 int mouseY = e.button.y;
 
-                mDataBuffers.SyncData(mRegistry);
-                SpawnParticles(mouseX, mouseY);
-                mDataBuffers.UpdateBuffers(mRegistry);
+                if(mEngine.IsSimulationThreaded()) {
+                    SpawnParticles(mouseX, mouseY);
+                } else {
+                    // Only the new particles are uploaded, the gpu keeps its state
+                    SpawnParticles(mouseX, mouseY);
+                    mDataBuffers.AppendParticles(mRegistry);
+                }
 
                 mouse.leftPressed = true;
 
@@ -123,7 +143,7 @@ void FluidApp::SpawnParticles(int mouseX, int mouseY) {
     for(int x = 0; x < particleSettings.radius; x++) {
         for(int y = 0; y < particleSettings.radius; y++) {
             for(int z = 0; z < particleSettings.radius; z++) {
-                mParticleSystem.CreateParticle(
+                CreateParticle(
                     x+worldPoint.x-middle, 
                     y+worldPoint.y-middle, 
                     z+worldPoint.z-middle, 
@@ -135,19 +155,79 @@ void FluidApp::SpawnParticles(int mouseX, int mouseY) {
     }
 }
 
+void FluidApp::CreateParticle(float x, float y, float z, float mass, glm::vec4 velocity) {
+    if(mEngine.IsSimulationThreaded()) {
+        mCpuSimulation.QueueParticle(glm::vec3(x, y, z), mass, velocity);
+        return;
+    }
+
+    mParticleSystem.CreateParticle(x, y, z, mass, velocity);
+}
+
 void FluidApp::FpsCounter(float deltaTime) {
     static float smoothedFPS = 0.0f;
     static float alpha = 0.1f;  
 
     float fps = 1.0f/deltaTime;
     smoothedFPS = alpha * fps + (1.0f - alpha) * smoothedFPS;
-    std::cout << "\33[2K\rFPS: " << static_cast<int>(smoothedFPS) << std::flush;
+    std::cout << "\33[2K\rFPS: " << static_cast<int>(smoothedFPS);
+    if(mGPUSphereDataSystem) {
+        std::cout << "  Ekin: " << mKineticEnergy << "  Vmax: " << mMaxSpeed;
+        std::cout << "  GPU " << mGPUSphereDataSystem->GetProfiler().GetSummary();
+    }
+    std::cout << std::flush;
+}
+
+void FluidApp::UpdateDiagnostics() {
+    if(!mGPUSphereDataSystem) {
+        return;
+    }
+
+    // A full ring skips this request, the next interval tries again
+    if(mDiagnosticsFrame++ % sapphire_config::DIAGNOSTICS_INTERVAL == 0) {
+        mDataBuffers.RequestSync(mRegistry.GetComponentPool<SphereComponent>().GetDenseEntities().size());
+    }
+    if(!mDataBuffers.PollSync(mRegistry)) {
+        return;
+    }
+
+    auto& velocityPool = mRegistry.GetComponentPool<VelocityComponent>();
+    auto& massPool     = mRegistry.GetComponentPool<MassComponent>();
+
+    mKineticEnergy = 0.0f;
+    mMaxSpeed      = 0.0f;
+    for(const auto& entityID : velocityPool.GetDenseEntities()) {
+        const glm::vec3 velocity = glm::vec3(velocityPool.GetComponent(entityID).v);
+        const float speedSquared = glm::dot(velocity, velocity);
+
+        mKineticEnergy += 0.5f * massPool.GetComponent(entityID).m * speedSquared;
+        mMaxSpeed       = std::max(mMaxSpeed, std::sqrt(speedSquared));
+    }
+}
+
+void FluidApp::UpdateProfilerOverlay() {
+    // Rebuilding text meshes every frame costs more than it shows
+    constexpr uint32_t REFRESH_INTERVAL = 30;
+    if(!mGPUSphereDataSystem || mOverlayFrame++ % REFRESH_INTERVAL != 0) {
+        return;
+    }
+
+    auto& labelPool  = mRegistry.GetComponentPool<TextMeshComponent>();
+    auto& objectPool = mRegistry.GetComponentPool<GuiObjectComponent>();
+    const auto& passes = mGPUSphereDataSystem->GetProfiler().GetPasses();
+
+    for(size_t i = 0; i < mProfilerLabels.size() && i < passes.size(); i++) {
+        labelPool.GetComponent(mProfilerLabels[i]).content = std::format("{} {:.3f} ms", passes[i].name, passes[i].GetAverage());
+        objectPool.GetComponent(mProfilerLabels[i]).isDirty = true;
+    }
 }
 
 void FluidApp::InitEntities() {
     // Singleton components
     mRegistry.EmplaceSingleton<MouseStateComponent>();
     mRegistry.EmplaceSingleton<ParticleSettingsComponent>();
+    mRegistry.EmplaceSingleton<TimeStepComponent>();
+    mRegistry.EmplaceSingleton<SimulationParametersComponent>(sapphire::LoadSimulationParameters(mConfigFilePath));
 
     // Camera
     bismuth::EntityID cameraEntity = mRegistry.CreateEntity();
@@ -182,7 +262,7 @@ void FluidApp::InitEntities() {
     for(int x = 0; x < amountX; x++) {
         for(int y = 0; y < amountY; y++) {
             for(int z = 0; z < amountZ; z++) {
-                mParticleSystem.CreateParticle(
+                CreateParticle(
                     x*sapphire_config::INITIAL_SPACING - coordOffsetX, 
                     y*sapphire_config::INITIAL_SPACING - coordOffsetY, 
                     z*sapphire_config::INITIAL_SPACING - coordOffsetZ - 40,
@@ -204,6 +284,11 @@ void FluidApp::InitInterface() {
     bismuth::EntityID horizontalGui4Entity = mRegistry.CreateEntity();
     bismuth::EntityID horizontalGui5Entity = mRegistry.CreateEntity();
 
+    bismuth::EntityID simulationLabelEntity = mRegistry.CreateEntity();
+    bismuth::EntityID horizontalGui6Entity = mRegistry.CreateEntity();
+    bismuth::EntityID horizontalGui7Entity = mRegistry.CreateEntity();
+    bismuth::EntityID horizontalGui8Entity = mRegistry.CreateEntity();
+
     glm::vec4 backgroundColor = {0.13f, 0.13f, 0.13f, 1.0f};
     glm::vec4 fontColor       = {0.9f, 0.9f, 0.9f, 1.0f};
 
@@ -235,6 +320,9 @@ void FluidApp::InitInterface() {
     TextMeshComponent label;
     label.content = "Particle Settings";
 
+    TextMeshComponent simulationLabel;
+    simulationLabel.content = "Simulation Settings";
+
     // Horizontal panels
     GuiObjectComponent horizontalGui;
     horizontalGui.style.Set(quartz::Properties::height,          quartz::Dimension{5.0f, quartz::Unit::Percent});
@@ -264,6 +352,17 @@ void FluidApp::InitInterface() {
     mRegistry.EmplaceComponent<GuiMeshComponent>(horizontalGui4Entity);
     mRegistry.EmplaceComponent<GuiObjectComponent>(horizontalGui5Entity, GuiObjectComponent(horizontalGui));
     mRegistry.EmplaceComponent<GuiMeshComponent>(horizontalGui5Entity);
+
+    mRegistry.EmplaceComponent<GuiObjectComponent>(simulationLabelEntity, GuiObjectComponent(labelObject));
+    mRegistry.EmplaceComponent<TextMeshComponent>(simulationLabelEntity, simulationLabel);
+    mRegistry.EmplaceComponent<GuiMeshComponent>(simulationLabelEntity);
+
+    mRegistry.EmplaceComponent<GuiObjectComponent>(horizontalGui6Entity, GuiObjectComponent(horizontalGui));
+    mRegistry.EmplaceComponent<GuiMeshComponent>(horizontalGui6Entity);
+    mRegistry.EmplaceComponent<GuiObjectComponent>(horizontalGui7Entity, GuiObjectComponent(horizontalGui));
+    mRegistry.EmplaceComponent<GuiMeshComponent>(horizontalGui7Entity);
+    mRegistry.EmplaceComponent<GuiObjectComponent>(horizontalGui8Entity, GuiObjectComponent(horizontalGui));
+    mRegistry.EmplaceComponent<GuiMeshComponent>(horizontalGui8Entity);
     
     auto& particleSettings = mRegistry.GetSingleton<ParticleSettingsComponent>();
 
@@ -309,6 +408,61 @@ void FluidApp::InitInterface() {
         fontSize2,
         particleSettings.velocity.z
     );
+
+    // Picked up by the gpu on the next step, no rebuild needed
+    auto& parameters = mRegistry.GetSingleton<SimulationParametersComponent>();
+
+    CreateRowGui(
+        horizontalGui6Entity,
+        "Gravity",
+        backgroundColor,
+        fontColor,
+        fontSize2,
+        parameters.g,
+        0.1f
+    );
+    CreateRowGui(
+        horizontalGui7Entity,
+        "CFL",
+        backgroundColor,
+        fontColor,
+        fontSize2,
+        parameters.cflFactor,
+        0.05f
+    );
+    CreateRowGui(
+        horizontalGui8Entity,
+        "Force dt",
+        backgroundColor,
+        fontColor,
+        fontSize2,
+        parameters.forceFactor,
+        0.05f
+    );
+
+    // Gpu profiler overlay, filled in as passes report
+    if(mEngine.IsSimulationThreaded()) {
+        return;
+    }
+
+    GuiObjectComponent profilerObject(labelObject);
+    profilerObject.style.Set(quartz::Properties::height,        quartz::Dimension{2.4f, quartz::Unit::Percent});
+    profilerObject.style.Set(quartz::Properties::margin_top,    quartz::Dimension{0.2f, quartz::Unit::Percent});
+    profilerObject.style.Set(quartz::Properties::margin_bottom, quartz::Dimension{0.2f, quartz::Unit::Percent});
+    profilerObject.style.Set(quartz::Properties::font_size,     quartz::Dimension{fontSize2, quartz::Unit::Percent});
+
+    TextMeshComponent profilerLabel;
+    profilerLabel.content = "-";
+
+    for(uint32_t i = 0; i < sapphire_config::GPU_PROFILER_OVERLAY_ROWS; i++) {
+        bismuth::EntityID rowEntity = mRegistry.CreateEntity();
+
+        mRegistry.EmplaceComponent<GuiObjectComponent>(rowEntity, GuiObjectComponent(profilerObject));
+        mRegistry.EmplaceComponent<TextMeshComponent>(rowEntity, profilerLabel);
+        mRegistry.EmplaceComponent<GuiMeshComponent>(rowEntity);
+
+        mProfilerLabels.push_back(rowEntity);
+    }
 }
 
 void FluidApp::CreateRowGui(
@@ -317,7 +471,8 @@ void FluidApp::CreateRowGui(
     glm::vec4   const& bgColor,
     glm::vec4   const& fontColor,
     float              fontSize,
-    float            & valueRef
+    float            & valueRef,
+    float              step
 ) {
     bismuth::EntityID labelEntity    = mRegistry.CreateEntity();
     bismuth::EntityID valueEntity    = mRegistry.CreateEntity();
@@ -361,14 +516,14 @@ void FluidApp::CreateRowGui(
     buttonUObject.style.Set(quartz::Properties::background_color, glm::vec4(0.0f,1.0f,0.0f,1.0f));
     buttonUObject.zLayer = -0.3f;
 
-    buttonU.onClick = [this, &valueRef, valueEntity](){
+    buttonU.onClick = [this, &valueRef, valueEntity, step](){
         auto& labelPool  = mRegistry.GetComponentPool<TextMeshComponent>();
         auto& objectPool = mRegistry.GetComponentPool<GuiObjectComponent>();
         auto& label      = labelPool.GetComponent(valueEntity);
         auto& object     = objectPool.GetComponent(valueEntity);
         object.isDirty = true;
         
-        valueRef++;
+        valueRef += step;
         label.content = std::format("{:.2f}", valueRef);
     };
 
@@ -377,15 +532,15 @@ void FluidApp::CreateRowGui(
     buttonDObject.style.Set(quartz::Properties::background_color, glm::vec4(1.0f,0.0f,0.0f,1.0f));
     buttonDObject.zLayer = -0.3f;
 
-    buttonD.onClick = [this, &valueRef, valueEntity](){
+    buttonD.onClick = [this, &valueRef, valueEntity, step](){
         auto& labelPool  = mRegistry.GetComponentPool<TextMeshComponent>();
         auto& objectPool = mRegistry.GetComponentPool<GuiObjectComponent>();
         auto& label      = labelPool.GetComponent(valueEntity);
         auto& object     = objectPool.GetComponent(valueEntity);
         object.isDirty = true;
 
-        valueRef--;
-        label.content = std::to_string(valueRef);
+        valueRef -= step;
+        label.content = std::format("{:.2f}", valueRef);
     };
 
     // Value
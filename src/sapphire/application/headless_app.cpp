@@ -0,0 +1,133 @@
+#include "sapphire/application/headless_app.hpp"
+
+HeadlessApp::HeadlessApp(const std::string& scenePath, std::shared_ptr<ITransport> transport) :
+    mScene(sapphire::LoadScene(scenePath)),
+    mSimulation(sapphire_config::MORTON_REORDER, mScene.neighborSearch) {
+    mSimulation.GetDomainCullingSystem().SetBounds(mScene.domainMin, mScene.domainMax);
+    if(transport && transport->GetSize() > 1) {
+        mSimulation.EnableDecomposition(std::move(transport));
+    }
+    InitEntities();
+
+    // Created on the main thread, pinned workers take over the pages of the ranges they work on
+    if(quartz::TaskPool::Get().IsPinned()) {
+        sapphire::FirstTouchParticles(mSimulation.GetRegistry());
+    }
+}
+
+void HeadlessApp::Run() {
+    std::filesystem::create_directories(mScene.outputDirectory);
+    mSimulation.GetDomainCullingSystem().SetLogPath((std::filesystem::path(mScene.outputDirectory) / RankFileName("escaped", ".csv")).string());
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(int step = 1; step <= mScene.steps; step++) {
+        mSimulation.Step();
+
+        bool isLast = step == mScene.steps;
+        if(isLast || (mScene.outputInterval > 0 && step % mScene.outputInterval == 0)) {
+            WriteSnapshot(step);
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto& registry = mSimulation.GetRegistry();
+    const auto& timeStep = registry.GetSingleton<TimeStepComponent>();
+
+    if(const auto* decomposition = mSimulation.GetDecompositionSystem()) {
+        std::cout << "Rank " << decomposition->GetRank() << ": ";
+    }
+    std::cout << "Simulated " << mScene.steps << " steps (t = " << timeStep.time << ") of "
+              << registry.GetComponentPool<SphereComponent>().GetDenseEntities().size() << " particles in "
+              << elapsed.count() << "s" << std::endl;
+
+    const size_t escaped = mSimulation.GetDomainCullingSystem().GetEscapedCount();
+    if(escaped > 0) {
+        std::cout << escaped << " particles left the domain, see " << RankFileName("escaped", ".csv") << std::endl;
+    }
+}
+
+void HeadlessApp::SetSteps(int steps) {
+    mScene.steps = steps;
+}
+void HeadlessApp::SetOutputDirectory(const std::string& outputDirectory) {
+    mScene.outputDirectory = outputDirectory;
+}
+
+
+// Private
+void HeadlessApp::InitEntities() {
+    auto& particleSystem = mSimulation.GetParticleSystem();
+    const auto* decomposition = mSimulation.GetDecompositionSystem();
+    size_t index = 0;
+
+    for(const auto& block : mScene.blocks) {
+        // Double so blocks far from the origin keep their spacing with DOUBLE_PRECISION_POSITIONS
+        const double spacing = block.spacing;
+        glm::dvec3 offset = glm::dvec3(block.count / 2) * spacing;
+
+        for(int x = 0; x < block.count.x; x++) {
+            for(int y = 0; y < block.count.y; y++) {
+                for(int z = 0; z < block.count.z; z++) {
+                    if(decomposition && !decomposition->IsInitialOwner(index++)) {
+                        continue;
+                    }
+                    particleSystem.CreateParticle(
+                        x*spacing - offset.x + block.center.x, 
+                        y*spacing - offset.y + block.center.y, 
+                        z*spacing - offset.z + block.center.z,
+                        block.mass,
+                        block.velocity,
+                        block.material,
+                        block.energy
+                    );
+                }
+            }
+        }
+    }
+}
+
+void HeadlessApp::WriteSnapshot(int step) {
+    auto& registry     = mSimulation.GetRegistry();
+    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& densityPool  = registry.GetComponentPool<DensityComponent>();
+    auto& pressurePool = registry.GetComponentPool<PressureComponent>();
+    auto& smoothingPool = registry.GetComponentPool<SmoothingLengthComponent>();
+    auto& activityPool  = registry.GetComponentPool<ActivityComponent>();
+    auto& precisePool   = registry.GetComponentPool<PrecisePositionComponent>();
+
+    std::filesystem::path path = std::filesystem::path(mScene.outputDirectory) / RankFileName(std::format("snapshot_{:06}", step), ".csv");
+    std::ofstream file(path);
+    if(!file) {
+        std::cerr << "Failed to open snapshot file: " << path << std::endl;
+        return;
+    }
+
+    if(sapphire_config::DOUBLE_PRECISION_POSITIONS) {
+        file << std::setprecision(15);
+    }
+
+    file << "id,x,y,z,vx,vy,vz,density,pressure,smoothing_length,dormant\n";
+    for(const auto& entityID : spherePool.GetDenseEntities()) {
+        const glm::dvec3 position = sapphire_config::DOUBLE_PRECISION_POSITIONS ?
+            precisePool.GetComponent(entityID).position :
+            glm::dvec3(glm::vec3(spherePool.GetComponent(entityID).positionAndRadius));
+        const auto& velocity = velocityPool.GetComponent(entityID).v;
+
+        file << entityID << ','
+             << position.x << ',' << position.y << ',' << position.z << ','
+             << velocity.x << ',' << velocity.y << ',' << velocity.z << ','
+             << densityPool.GetComponent(entityID).d << ','
+             << pressurePool.GetComponent(entityID).p << ','
+             << smoothingPool.GetComponent(entityID).h << ','
+             << activityPool.GetComponent(entityID).dormant << '\n';
+    }
+}
+
+std::string HeadlessApp::RankFileName(const std::string& stem, const std::string& extension) const {
+    if(const auto* decomposition = mSimulation.GetDecompositionSystem()) {
+        return std::format("{}_rank{}{}", stem, decomposition->GetRank(), extension);
+    }
+    return stem + extension;
+}
@@ -0,0 +1,220 @@
+#include "sapphire/distributed/unix_socket_transport.hpp"
+
+// C++ standard libraries
+#include <cerrno>
+#include <cstring>
+
+// Third_party libraries
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    [[noreturn]] void Fail(const char* what) {
+        std::cerr << "Transport: " << what << " failed: " << std::strerror(errno) << std::endl;
+        exit(1);
+    }
+
+    // Messages are a 64 bit payload length followed by the payload
+    struct Channel {
+        std::vector<std::byte> send;
+        size_t sent = 0;
+
+        std::byte header[sizeof(uint64_t)];
+        size_t headerReceived = 0;
+        size_t received = 0;
+        bool receiving = true;
+    };
+}
+
+std::unique_ptr<UnixSocketTransport> UnixSocketTransport::Launch(int processCount) {
+    // ends[a][b] is the socket rank a talks to rank b through
+    std::vector<std::vector<int>> ends(processCount, std::vector<int>(processCount, -1));
+    for(int a = 0; a < processCount; a++) {
+        for(int b = a + 1; b < processCount; b++) {
+            int pair[2];
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) < 0) {
+                Fail("socketpair");
+            }
+            ends[a][b] = pair[0];
+            ends[b][a] = pair[1];
+        }
+    }
+
+    // Buffered output would be printed once per process
+    std::cout.flush();
+    std::cerr.flush();
+
+    int rank = 0;
+    std::vector<pid_t> children;
+    for(int child = 1; child < processCount; child++) {
+        const pid_t pid = fork();
+        if(pid < 0) {
+            Fail("fork");
+        }
+        if(pid == 0) {
+            rank = child;
+            children.clear();
+            break;
+        }
+        children.push_back(pid);
+    }
+
+    for(int a = 0; a < processCount; a++) {
+        for(int b = 0; b < processCount; b++) {
+            if(a != rank && ends[a][b] >= 0) {
+                close(ends[a][b]);
+            }
+        }
+    }
+    for(const auto& socket : ends[rank]) {
+        if(socket >= 0 && fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) < 0) {
+            Fail("fcntl");
+        }
+    }
+
+    return std::unique_ptr<UnixSocketTransport>(new UnixSocketTransport(rank, ends[rank], children));
+}
+
+UnixSocketTransport::UnixSocketTransport(int rank, std::vector<int> sockets, std::vector<pid_t> children) :
+    mRank(rank), mSockets(std::move(sockets)), mChildren(std::move(children)) {
+}
+
+UnixSocketTransport::~UnixSocketTransport() {
+    for(const auto& socket : mSockets) {
+        if(socket >= 0) {
+            close(socket);
+        }
+    }
+
+    for(const auto& child : mChildren) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << "Process " << child << " did not exit cleanly" << std::endl;
+        }
+    }
+}
+
+int UnixSocketTransport::GetRank() const {
+    return mRank;
+}
+int UnixSocketTransport::GetSize() const {
+    return mSockets.size();
+}
+
+std::vector<std::vector<std::byte>> UnixSocketTransport::Exchange(const std::vector<std::vector<std::byte>>& outgoing) {
+    const int size = GetSize();
+
+    std::vector<std::vector<std::byte>> incoming(size);
+    incoming[mRank] = outgoing[mRank];
+
+    std::vector<Channel> channels(size);
+    size_t pending = 0;
+    for(int peer = 0; peer < size; peer++) {
+        if(peer == mRank) {
+            continue;
+        }
+        const uint64_t length = outgoing[peer].size();
+        auto& send = channels[peer].send;
+        send.resize(sizeof(length) + length);
+        std::memcpy(send.data(), &length, sizeof(length));
+        std::memcpy(send.data() + sizeof(length), outgoing[peer].data(), length);
+        pending += 2;
+    }
+
+    // Sends and receives interleave, a blocking send to a full socket would deadlock two ranks sending to each other
+    std::vector<pollfd> polls;
+    std::vector<int> pollRanks;
+    while(pending > 0) {
+        polls.clear();
+        pollRanks.clear();
+        for(int peer = 0; peer < size; peer++) {
+            if(peer == mRank) {
+                continue;
+            }
+            const Channel& channel = channels[peer];
+            short events = 0;
+            if(channel.sent < channel.send.size()) {
+                events |= POLLOUT;
+            }
+            if(channel.receiving) {
+                events |= POLLIN;
+            }
+            if(events) {
+                polls.push_back({mSockets[peer], events, 0});
+                pollRanks.push_back(peer);
+            }
+        }
+
+        if(poll(polls.data(), polls.size(), -1) < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            Fail("poll");
+        }
+
+        for(size_t i = 0; i < polls.size(); i++) {
+            const int peer = pollRanks[i];
+            const int socket = polls[i].fd;
+            Channel& channel = channels[peer];
+
+            if(polls[i].revents & POLLOUT) {
+                const ssize_t count = send(socket, channel.send.data() + channel.sent, channel.send.size() - channel.sent, MSG_NOSIGNAL);
+                if(count < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    Fail("send");
+                }
+                if(count > 0) {
+                    channel.sent += count;
+                    if(channel.sent == channel.send.size()) {
+                        pending--;
+                    }
+                }
+            }
+
+            if(polls[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                std::byte* target;
+                size_t remaining;
+                if(channel.headerReceived < sizeof(channel.header)) {
+                    target    = channel.header + channel.headerReceived;
+                    remaining = sizeof(channel.header) - channel.headerReceived;
+                } else {
+                    target    = incoming[peer].data() + channel.received;
+                    remaining = incoming[peer].size() - channel.received;
+                }
+
+                const ssize_t count = recv(socket, target, remaining, 0);
+                if(count == 0) {
+                    std::cerr << "Transport: rank " << peer << " closed its connection" << std::endl;
+                    exit(1);
+                }
+                if(count < 0) {
+                    if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                        continue;
+                    }
+                    Fail("recv");
+                }
+
+                if(channel.headerReceived < sizeof(channel.header)) {
+                    channel.headerReceived += count;
+                    if(channel.headerReceived == sizeof(channel.header)) {
+                        uint64_t length;
+                        std::memcpy(&length, channel.header, sizeof(length));
+                        incoming[peer].resize(length);
+                    }
+                } else {
+                    channel.received += count;
+                }
+
+                if(channel.headerReceived == sizeof(channel.header) && channel.received == incoming[peer].size()) {
+                    channel.receiving = false;
+                    pending--;
+                }
+            }
+        }
+    }
+
+    return incoming;
+}
@@ -0,0 +1,52 @@
+#include "sapphire/eos/eos_table.hpp"
+
+sapphire::EosTable::EosTable(MaterialType material, uint32_t densitySamples, uint32_t energySamples) {
+    const double rho0 = RestDensity(material);
+
+    // The fluid law ignores energy, two rows are enough
+    double densityMin = 0.0;
+    double densityMax = sapphire_config::EOS_MAX_COMPRESSION * rho0;
+    double energyMax  = 1.0;
+    if(material == MaterialType::Fluid) {
+        energySamples = 2;
+    }
+    else {
+        // Tillotson is singular at zero density
+        densityMin = 0.05 * rho0;
+        energyMax  = sapphire_config::EOS_MAX_ENERGY_FACTOR * GetTillotsonParameters(material).EsPrime;
+    }
+    densitySamples = std::max(densitySamples, 2u);
+    energySamples  = std::max(energySamples, 2u);
+
+    const double densityStep = (densityMax - densityMin) / (densitySamples - 1);
+    const double energyStep  = energyMax / (energySamples - 1);
+
+    mSize        = glm::uvec2(densitySamples, energySamples);
+    mOrigin      = glm::vec2(densityMin, 0.0f);
+    mInverseStep = glm::vec2(1.0 / densityStep, 1.0 / energyStep);
+
+    mSamples.resize(static_cast<size_t>(densitySamples) * energySamples);
+    for(uint32_t j = 0; j < energySamples; j++) {
+        for(uint32_t i = 0; i < densitySamples; i++) {
+            const double density = densityMin + i * densityStep;
+            const double energy  = j * energyStep;
+
+            mSamples[static_cast<size_t>(j) * densitySamples + i] = glm::vec2(
+                Pressure(material, density, energy),
+                SoundSpeed(material, density, energy)
+            );
+        }
+    }
+
+    mReferenceSoundSpeed = SoundSpeed(material, rho0, sapphire_config::INITIAL_ENERGY);
+}
+
+const sapphire::EosTable& sapphire::GetEosTable(MaterialType material) {
+    static const std::array<EosTable, MATERIAL_COUNT> tables = {
+        EosTable(MaterialType::Fluid),
+        EosTable(MaterialType::Basalt),
+        EosTable(MaterialType::Granite),
+        EosTable(MaterialType::Iron)
+    };
+    return tables[static_cast<size_t>(material)];
+}
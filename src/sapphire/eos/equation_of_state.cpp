@@ -0,0 +1,70 @@
+#include "sapphire/eos/equation_of_state.hpp"
+
+sapphire::TillotsonParameters sapphire::GetTillotsonParameters(MaterialType material) {
+    switch(material) {
+        case MaterialType::Basalt:
+            return {2700.0, 26.7e9, 26.7e9, 487.0e6, 4.72e6, 18.2e6, 0.5, 1.5, 5.0, 5.0};
+        case MaterialType::Granite:
+            return {2680.0, 18.0e9, 18.0e9,  16.0e6, 3.5e6,  18.0e6, 0.5, 1.3, 5.0, 5.0};
+        case MaterialType::Iron:
+            return {7800.0, 128.0e9, 105.0e9, 9.5e6, 2.4e6,  8.67e6, 0.5, 1.5, 5.0, 5.0};
+        default:
+            std::cerr << "Material has no Tillotson parameters" << std::endl;
+            exit(1);
+    }
+}
+
+double sapphire::TillotsonPressure(const TillotsonParameters& parameters, double density, double energy) {
+    const auto& [rho0, A, B, E0, Es, EsPrime, a, b, alpha, beta] = parameters;
+
+    const double eta   = density / rho0;
+    const double mu    = eta - 1.0;
+    const double omega = energy / (E0 * eta * eta) + 1.0;
+
+    const double compressed = (a + b / omega) * density * energy + A * mu + B * mu * mu;
+    if(density >= rho0 || energy <= Es) {
+        return compressed;
+    }
+
+    const double expansion = rho0 / density - 1.0;
+    const double expanded = a * density * energy
+        + (b * density * energy / omega + A * mu * std::exp(-beta * expansion)) * std::exp(-alpha * expansion * expansion);
+    if(energy >= EsPrime) {
+        return expanded;
+    }
+
+    // Partial vaporization, blend the two branches by energy
+    return ((energy - Es) * expanded + (EsPrime - energy) * compressed) / (EsPrime - Es);
+}
+
+double sapphire::Pressure(MaterialType material, double density, double energy) {
+    if(material == MaterialType::Fluid) {
+        return sapphire_config::STIFFNESS * (density - sapphire_config::REST_DENSITY);
+    }
+    return TillotsonPressure(GetTillotsonParameters(material), density, energy);
+}
+
+double sapphire::SoundSpeed(MaterialType material, double density, double energy) {
+    const double rho0 = RestDensity(material);
+    const double densityStep = 1e-4 * rho0;
+    const double energyStep  = material == MaterialType::Fluid ? 1e-4 : 1e-4 * GetTillotsonParameters(material).EsPrime;
+
+    // Stay on the positive side near zero density
+    const double low = std::max(density - densityStep, 0.5 * densityStep);
+    const double dPdRho = (Pressure(material, density + densityStep, energy) - Pressure(material, low, energy)) / (density + densityStep - low);
+    const double dPdE   = (Pressure(material, density, energy + energyStep) - Pressure(material, density, std::max(energy - energyStep, 0.0)))
+        / (energy + energyStep - std::max(energy - energyStep, 0.0));
+
+    const double pressure = Pressure(material, density, energy);
+    const double squared = dPdRho + (density > 0.0 ? pressure / (density * density) * dPdE : 0.0);
+
+    // Tension states can go below zero, they carry no sound
+    return std::sqrt(std::max(squared, 0.0));
+}
+
+double sapphire::RestDensity(MaterialType material) {
+    if(material == MaterialType::Fluid) {
+        return sapphire_config::REST_DENSITY;
+    }
+    return GetTillotsonParameters(material).restDensity;
+}
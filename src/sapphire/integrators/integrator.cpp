@@ -0,0 +1,16 @@
+#include "sapphire/integrators/integrator.hpp"
+#include "sapphire/integrators/symplectic_euler_integrator.hpp"
+#include "sapphire/integrators/leapfrog_integrator.hpp"
+#include "sapphire/integrators/velocity_verlet_integrator.hpp"
+
+std::unique_ptr<IIntegrator> CreateIntegrator(IntegratorType type) {
+    switch(type) {
+        case IntegratorType::Leapfrog:
+            return std::make_unique<LeapfrogIntegrator>();
+        case IntegratorType::VelocityVerlet:
+            return std::make_unique<VelocityVerletIntegrator>();
+        case IntegratorType::SymplecticEuler:
+        default:
+            return std::make_unique<SymplecticEulerIntegrator>();
+    }
+}
@@ -0,0 +1,49 @@
+#include "sapphire/integrators/leapfrog_integrator.hpp"
+
+void LeapfrogIntegrator::Predict(bismuth::Registry& registry, float deltaTime) {
+    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
+    auto& precisePool  = registry.GetComponentPool<PrecisePositionComponent>();
+    auto& forcePool    = registry.GetComponentPool<ForceComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool     = registry.GetComponentPool<MassComponent>();
+
+    auto& sphereIDs = spherePool.GetDenseEntities();
+    const float halfStep = 0.5f * deltaTime;
+
+    // Kick - drift
+    quartz::TaskPool::Get().ParallelFor(0, sphereIDs.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = sphereIDs[i];
+
+            glm::vec4& velocity = velocityPool.GetComponent(entityID).v;
+            auto& mass  = massPool.GetComponent(entityID).m;
+            auto& force = forcePool.GetComponent(entityID).f;
+
+            velocity += (force / mass) * halfStep;
+            sapphire::Translate(spherePool, precisePool, entityID, velocity * deltaTime);
+        }
+    });
+}
+
+void LeapfrogIntegrator::Correct(bismuth::Registry& registry, float deltaTime) {
+    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
+    auto& forcePool    = registry.GetComponentPool<ForceComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool     = registry.GetComponentPool<MassComponent>();
+
+    auto& sphereIDs = spherePool.GetDenseEntities();
+    const float halfStep = 0.5f * deltaTime;
+
+    // Closing kick
+    quartz::TaskPool::Get().ParallelFor(0, sphereIDs.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = sphereIDs[i];
+
+            glm::vec4& velocity = velocityPool.GetComponent(entityID).v;
+            auto& mass  = massPool.GetComponent(entityID).m;
+            auto& force = forcePool.GetComponent(entityID).f;
+
+            velocity += (force / mass) * halfStep;
+        }
+    });
+}
@@ -0,0 +1,28 @@
+#include "sapphire/integrators/symplectic_euler_integrator.hpp"
+
+void SymplecticEulerIntegrator::Predict(bismuth::Registry&, float) {
+    // Whole step happens after the forces are known
+}
+
+void SymplecticEulerIntegrator::Correct(bismuth::Registry& registry, float deltaTime) {
+    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
+    auto& precisePool  = registry.GetComponentPool<PrecisePositionComponent>();
+    auto& forcePool    = registry.GetComponentPool<ForceComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool     = registry.GetComponentPool<MassComponent>();
+
+    auto& sphereIDs = spherePool.GetDenseEntities();
+
+    quartz::TaskPool::Get().ParallelFor(0, sphereIDs.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = sphereIDs[i];
+
+            glm::vec4& velocity = velocityPool.GetComponent(entityID).v;
+            auto& mass  = massPool.GetComponent(entityID).m;
+            auto& force = forcePool.GetComponent(entityID).f;
+
+            velocity += (force / mass) * deltaTime;
+            sapphire::Translate(spherePool, precisePool, entityID, velocity * deltaTime);
+        }
+    });
+}
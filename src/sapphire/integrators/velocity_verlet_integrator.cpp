@@ -0,0 +1,56 @@
+#include "sapphire/integrators/velocity_verlet_integrator.hpp"
+
+void VelocityVerletIntegrator::Predict(bismuth::Registry& registry, float deltaTime) {
+    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
+    auto& precisePool  = registry.GetComponentPool<PrecisePositionComponent>();
+    auto& forcePool    = registry.GetComponentPool<ForceComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool     = registry.GetComponentPool<MassComponent>();
+
+    auto& sphereIDs = spherePool.GetDenseEntities();
+    mPreviousAcceleration.resize(sphereIDs.size());
+
+    const float halfStepSquared = 0.5f * deltaTime * deltaTime;
+
+    // x(t+dt) = x(t) + v(t)dt + a(t)dt^2/2
+    quartz::TaskPool::Get().ParallelFor(0, sphereIDs.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = sphereIDs[i];
+
+            const glm::vec4& velocity = velocityPool.GetComponent(entityID).v;
+            auto& mass  = massPool.GetComponent(entityID).m;
+            auto& force = forcePool.GetComponent(entityID).f;
+
+            glm::vec4 acceleration = force / mass;
+            mPreviousAcceleration[i] = acceleration;
+
+            sapphire::Translate(spherePool, precisePool, entityID, velocity * deltaTime + acceleration * halfStepSquared);
+        }
+    });
+}
+
+void VelocityVerletIntegrator::Correct(bismuth::Registry& registry, float deltaTime) {
+    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
+    auto& forcePool    = registry.GetComponentPool<ForceComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool     = registry.GetComponentPool<MassComponent>();
+
+    auto& sphereIDs = spherePool.GetDenseEntities();
+    // Particles spawned between Predict and Correct start without history
+    mPreviousAcceleration.resize(sphereIDs.size(), glm::vec4(0.0f));
+
+    const float halfStep = 0.5f * deltaTime;
+
+    // v(t+dt) = v(t) + (a(t) + a(t+dt))dt/2
+    quartz::TaskPool::Get().ParallelFor(0, sphereIDs.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = sphereIDs[i];
+
+            glm::vec4& velocity = velocityPool.GetComponent(entityID).v;
+            auto& mass  = massPool.GetComponent(entityID).m;
+            auto& force = forcePool.GetComponent(entityID).f;
+
+            velocity += (mPreviousAcceleration[i] + force / mass) * halfStep;
+        }
+    });
+}
@@ -0,0 +1,102 @@
+#include "sapphire/kernels/kernel_glsl.hpp"
+
+// C++ standard libraries
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    std::string Literal(double value) {
+        std::ostringstream stream;
+        // No negative zeros in the output
+        stream << std::scientific << std::setprecision(9) << (value == 0.0 ? 0.0f : static_cast<float>(value));
+        return stream.str();
+    }
+
+    // Piece polynomial in v = end*h - r, coefficient i scaled by scale / h^i
+    std::string Horner(const sapphire::Polynomial& polynomial, double scale, double smoothingLength) {
+        const size_t size = polynomial.Size();
+        if(size == 0) {
+            return "0.0";
+        }
+
+        // Vanishing low order terms become a plain power of v
+        size_t lowest = 0;
+        while(polynomial.coefficients[lowest] == 0.0) {
+            lowest++;
+        }
+
+        std::string expression = Literal(polynomial.coefficients[size-1] * scale / std::pow(smoothingLength, size-1));
+        for(size_t i = size-1; i > lowest; i--) {
+            expression = Literal(polynomial.coefficients[i-1] * scale / std::pow(smoothingLength, i-1)) + " + v*(" + expression + ")";
+        }
+        if(lowest > 0) {
+            expression = "(" + expression + ")";
+        }
+        for(size_t i = 0; i < lowest; i++) {
+            expression = "v*" + expression;
+        }
+        return expression;
+    }
+
+    template<size_t N>
+    std::string PiecewiseFunction(
+        const std::string& signature,
+        const std::array<sapphire::KernelPiece, N>& pieces,
+        double scale,
+        double smoothingLength
+    ) {
+        std::ostringstream stream;
+        stream << signature << " {\n";
+        for(const auto& piece : pieces) {
+            const std::string end = Literal(piece.end * smoothingLength);
+            stream << "    if(r < " << end << ") {\n"
+                   << "        float v = " << end << " - r;\n"
+                   << "        return " << Horner(piece.shape, scale, smoothingLength) << ";\n"
+                   << "    }\n";
+        }
+        stream << "    return 0.0;\n}\n";
+        return stream.str();
+    }
+
+    template<typename Kernel, typename Policy>
+    std::string Generate(float supportRadius) {
+        const double h = supportRadius / Kernel::SUPPORT;
+        const double normalization = Policy::NORMALIZATION / (h*h*h);
+
+        std::ostringstream stream;
+        stream << "// Generated from the " << Policy::NAME << " kernel policy\n"
+               << "const float KERNEL_SUPPORT_RADIUS = " << Literal(supportRadius) << ";\n\n"
+               << PiecewiseFunction("float KernelW(float r)", Kernel::PIECES, normalization, h) << "\n"
+               << PiecewiseFunction("float KernelDerivative(float r)", Kernel::DERIVATIVE_PIECES, normalization / h, h) << "\n"
+               << "vec3 KernelGradient(vec3 deltaPoint, float r) {\n"
+               << "    if(r == 0.0) {\n"
+               << "        return vec3(0.0);\n"
+               << "    }\n"
+               << "    return KernelDerivative(r) * (deltaPoint / r);\n"
+               << "}\n\n"
+               << "float KernelLaplacian(float r) {\n"
+               << "    if(r == 0.0) {\n"
+               << "        return 0.0;\n"
+               << "    }\n"
+               << "    return -2.0 * KernelDerivative(r) / r;\n"
+               << "}\n";
+        return stream.str();
+    }
+}
+
+namespace sapphire {
+    std::string GenerateKernelGLSL(KernelType type, float supportRadius) {
+        switch(type) {
+            case KernelType::WendlandC2:
+                return Generate<WendlandC2Kernel, WendlandC2Policy>(supportRadius);
+            case KernelType::WendlandC4:
+                return Generate<WendlandC4Kernel, WendlandC4Policy>(supportRadius);
+            case KernelType::Quintic:
+                return Generate<QuinticKernel, QuinticPolicy>(supportRadius);
+            case KernelType::CubicSpline:
+            default:
+                return Generate<CubicSplineKernel, CubicSplinePolicy>(supportRadius);
+        }
+    }
+}
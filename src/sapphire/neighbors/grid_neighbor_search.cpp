@@ -0,0 +1,106 @@
+#include "sapphire/neighbors/grid_neighbor_search.hpp"
+
+void GridNeighborSearch::Build(bismuth::Registry& registry) {
+    mRegistry = &registry;
+    mPosToSpatialSystem.Update(registry);
+}
+
+void GridNeighborSearch::Query(size_t entityID, float radius, std::vector<size_t>& neighbors) const {
+    using sapphire_config::SPATIAL_LENGTH;
+    using sapphire_config::SPATIAL_LENGTH_MAX;
+
+    auto& spherePool  = mRegistry->GetComponentPool<SphereComponent>();
+    auto& spatialPool = mRegistry->GetComponentPool<SpatialHashComponent>();
+    auto& posPool     = mRegistry->GetComponentPool<PositionComponent>();
+
+    SphereComponent      const* positionArray        = spherePool.GetDenseComponents().data();
+    PositionComponent    const* spatialPosArray      = posPool.GetDenseComponents().data();
+    SpatialHashComponent const* spatialHashArray     = spatialPool.GetDenseComponents().data();
+    uint32_t             const* positionLocations    = spherePool.GetComponentLocations().data();
+    uint32_t             const* spatialPositionLoc   = posPool.GetComponentLocations().data();
+    uint32_t             const* spatialHashLocations = spatialPool.GetComponentLocations().data();
+
+    const auto& spatialDenseEntities = spatialPool.GetDenseEntities();
+
+    size_t count = 0;
+    size_t* tmp = (size_t*)alloca(spherePool.GetDenseEntities().size() * sizeof(size_t));
+
+    float radiusSquaredMax = radius * radius;
+    glm::vec3 currentPos = glm::vec3(positionArray[positionLocations[entityID]].positionAndRadius);
+
+    // Translate global to local spatial space
+    int chunkY = std::floor(currentPos.y / SPATIAL_LENGTH_MAX);
+    int chunkX = std::floor(currentPos.x / SPATIAL_LENGTH_MAX);
+    int chunkZ = std::floor(currentPos.z / SPATIAL_LENGTH_MAX);
+    
+    float localPosX = currentPos.x - SPATIAL_LENGTH_MAX*chunkX;
+    float localPosY = currentPos.y - SPATIAL_LENGTH_MAX*chunkY;
+    float localPosZ = currentPos.z - SPATIAL_LENGTH_MAX*chunkZ;
+    
+    int cubeX = std::floor(SPATIAL_LENGTH * (localPosX / SPATIAL_LENGTH_MAX));
+    int cubeY = std::floor(SPATIAL_LENGTH * (localPosY / SPATIAL_LENGTH_MAX));
+    int cubeZ = std::floor(SPATIAL_LENGTH * (localPosZ / SPATIAL_LENGTH_MAX));
+
+    // Cells are SMOOTHING_LENGTH wide, larger radii look further out
+    const int reach = std::max(1, static_cast<int>(std::ceil(radius * SPATIAL_LENGTH / SPATIAL_LENGTH_MAX)));
+
+    for(int localX = -reach; localX <= reach; localX++) {
+        for(int localY = -reach; localY <= reach; localY++) {
+            for(int localZ = -reach; localZ <= reach; localZ++) {
+                int neighborX = cubeX + localX;
+                int neighborY = cubeY + localY;
+                int neighborZ = cubeZ + localZ;
+
+                int chunkNeighborX;
+                int chunkNeighborY;
+                int chunkNeighborZ;
+
+                CheckNeighbor(chunkX, chunkNeighborX, neighborX);
+                CheckNeighbor(chunkY, chunkNeighborY, neighborY);
+                CheckNeighbor(chunkZ, chunkNeighborZ, neighborZ);
+
+                glm::vec3 chunkKey(chunkNeighborX, chunkNeighborY, chunkNeighborZ);
+                int flatIndex = SpatialHash::GetCoordinates(neighborX, neighborY, neighborZ);
+                
+                for(const auto& spatialID : spatialDenseEntities) {
+                    const auto& spatialPos = spatialPosArray[spatialPositionLoc[spatialID]].position;
+
+                    if(spatialPos != chunkKey) {
+                        continue;
+                    }
+                    
+                    const auto& spatial = spatialHashArray[spatialHashLocations[spatialID]];
+                    const auto& entityArray = spatial.flatArrayIDs[flatIndex];
+                    
+                    for(const auto& ID : entityArray) {
+                        const glm::vec3 point = currentPos - glm::vec3(positionArray[positionLocations[ID]].positionAndRadius);
+                        const float radiusSquared = sapphire::Dot(point, point);
+                        
+                        if(radiusSquared <= radiusSquaredMax) {
+                            tmp[count] = ID;
+                            count++;
+                        }
+                    } 
+                }
+            }   
+        }
+    }
+
+    neighbors.resize(count);
+    if (count > 0) {
+        memcpy(neighbors.data(),
+                    tmp,
+                    count * sizeof(size_t));
+    }
+}
+
+
+// Private
+void GridNeighborSearch::CheckNeighbor(int currentChunk, int& chunkNeighbor, int& neighbor) {
+    using sapphire_config::SPATIAL_LENGTH;
+
+    // Cells past the chunk edge belong to a neighboring chunk, wide searches can skip over several
+    int chunkOffset = neighbor >= 0 ? neighbor / SPATIAL_LENGTH : -((SPATIAL_LENGTH - 1 - neighbor) / SPATIAL_LENGTH);
+    chunkNeighbor = currentChunk + chunkOffset;
+    neighbor -= chunkOffset * SPATIAL_LENGTH;
+}
@@ -0,0 +1,342 @@
+#include "sapphire/neighbors/kd_tree_neighbor_search.hpp"
+
+namespace {
+    float BoxDistanceSquared(glm::vec3 const& boundsMin, glm::vec3 const& boundsMax, glm::vec3 const& point) {
+        const glm::vec3 delta = glm::max(glm::max(boundsMin - point, point - boundsMax), glm::vec3(0.0f));
+        return glm::dot(delta, delta);
+    }
+
+    float BoxBoxDistanceSquared(glm::vec3 const& aMin, glm::vec3 const& aMax, glm::vec3 const& bMin, glm::vec3 const& bMax) {
+        const glm::vec3 delta = glm::max(glm::max(aMin - bMax, bMin - aMax), glm::vec3(0.0f));
+        return glm::dot(delta, delta);
+    }
+}
+
+void KdTreeNeighborSearch::Build(bismuth::Registry& registry) {
+    using namespace sapphire_config;
+
+    if(mRefits < KD_TREE_MAX_REFITS && !mNodes.empty() && Refit(registry)) {
+        mRefits++;
+        if(LeafSurfaceArea() <= KD_TREE_REFIT_GROWTH * mBuildSurfaceArea) {
+            return;
+        }
+    }
+
+    Rebuild(registry);
+    mRefits = 0;
+    mBuildSurfaceArea = LeafSurfaceArea();
+}
+
+void KdTreeNeighborSearch::Query(size_t entityID, float radius, std::vector<size_t>& neighbors) const {
+    neighbors.clear();
+    if(mNodes.empty()) {
+        return;
+    }
+
+    const glm::vec3 point = mPoints[mSlots[entityID]];
+    const float radiusSquared = radius * radius;
+
+    // Balanced tree, the depth stays far below the stack size
+    uint32_t stack[64];
+    size_t top = 0;
+    stack[top++] = 0;
+
+    while(top > 0) {
+        const uint32_t nodeIndex = stack[--top];
+        const Node& node = mNodes[nodeIndex];
+
+        if(BoxDistanceSquared(node.boundsMin, node.boundsMax, point) > radiusSquared) {
+            continue;
+        }
+        if(node.right == 0) {
+            QueryLeaf(node, point, radiusSquared, neighbors);
+            continue;
+        }
+        stack[top++] = node.right;
+        stack[top++] = nodeIndex + 1;
+    }
+}
+
+void KdTreeNeighborSearch::QueryBatch(
+    std::vector<uint32_t>            const& entityIDs,
+    std::vector<float>               const& radii,
+    std::vector<uint32_t>            const& costs,
+    std::vector<std::vector<size_t>>&       neighbors
+) const {
+    using sapphire_config::KD_TREE_BATCH_SIZE;
+
+    const size_t queryCount = entityIDs.size();
+    if(mNodes.empty()) {
+        for(size_t i = 0; i < queryCount; i++) {
+            neighbors[i].clear();
+        }
+        return;
+    }
+
+    const size_t batchCount = (queryCount + KD_TREE_BATCH_SIZE - 1) / KD_TREE_BATCH_SIZE;
+    std::vector<uint32_t> batchCosts(batchCount, 0);
+    for(size_t i = 0; i < queryCount; i++) {
+        batchCosts[i / KD_TREE_BATCH_SIZE] += costs[i] + 1;
+    }
+
+    quartz::TaskPool::Get().ParallelForWeighted(batchCosts, [&](size_t begin, size_t end) {
+        std::vector<uint32_t> leaves;
+
+        for(size_t batch = begin; batch < end; batch++) {
+            const size_t first = batch * KD_TREE_BATCH_SIZE;
+            const size_t last  = std::min(first + KD_TREE_BATCH_SIZE, queryCount);
+
+            glm::vec3 boundsMin( std::numeric_limits<float>::max());
+            glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+            float maxRadius = 0.0f;
+
+            for(size_t i = first; i < last; i++) {
+                const glm::vec3& point = mPoints[mSlots[entityIDs[i]]];
+                boundsMin = glm::min(boundsMin, point);
+                boundsMax = glm::max(boundsMax, point);
+                maxRadius = std::max(maxRadius, radii[i]);
+            }
+
+            // One traversal for the whole batch, each query then only visits the shared leaves
+            leaves.clear();
+            CollectLeaves(boundsMin, boundsMax, maxRadius, leaves);
+
+            for(size_t i = first; i < last; i++) {
+                const glm::vec3& point = mPoints[mSlots[entityIDs[i]]];
+                const float radiusSquared = radii[i] * radii[i];
+
+                neighbors[i].clear();
+                for(const auto& leafIndex : leaves) {
+                    const Node& leaf = mNodes[leafIndex];
+                    if(BoxDistanceSquared(leaf.boundsMin, leaf.boundsMax, point) <= radiusSquared) {
+                        QueryLeaf(leaf, point, radiusSquared, neighbors[i]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+
+// Private
+void KdTreeNeighborSearch::Rebuild(bismuth::Registry& registry) {
+    using sapphire_config::KD_TREE_LEAF_SIZE;
+
+    auto& spherePool = registry.GetComponentPool<SphereComponent>();
+    const auto& spheres  = spherePool.GetDenseComponents();
+    const auto& entities = spherePool.GetDenseEntities();
+    const uint32_t count = entities.size();
+
+    mNodes.clear();
+    mLeaves.clear();
+    if(count == 0) {
+        mPoints.clear();
+        mEntityIDs.clear();
+        return;
+    }
+
+    std::vector<glm::vec3> positions(count);
+    for(uint32_t i = 0; i < count; i++) {
+        positions[i] = glm::vec3(spheres[i].positionAndRadius);
+    }
+
+    mOrder.resize(count);
+    std::iota(mOrder.begin(), mOrder.end(), 0);
+    mNodes.resize(CountNodes(count));
+
+    // Split the top levels serially until there are enough independent subtrees for every worker
+    struct Subtree {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+    };
+    auto& taskPool = quartz::TaskPool::Get();
+    const size_t targetSubtrees = 4 * taskPool.GetThreadCount();
+
+    std::vector<Subtree> subtrees = {{0, 0, count}};
+    bool splitAny = true;
+    while(splitAny && subtrees.size() < targetSubtrees) {
+        splitAny = false;
+
+        std::vector<Subtree> next;
+        for(const auto& subtree : subtrees) {
+            if(subtree.end - subtree.begin <= KD_TREE_LEAF_SIZE) {
+                next.push_back(subtree);
+                continue;
+            }
+            const uint32_t middle = SplitNode(subtree.node, subtree.begin, subtree.end, positions);
+            next.push_back({subtree.node + 1, subtree.begin, middle});
+            next.push_back({mNodes[subtree.node].right, middle, subtree.end});
+            splitAny = true;
+        }
+        subtrees.swap(next);
+    }
+
+    taskPool.ParallelFor(0, subtrees.size(), 1, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            BuildNode(subtrees[i].node, subtrees[i].begin, subtrees[i].end, positions);
+        }
+    });
+
+    mPoints.resize(count);
+    mEntityIDs.resize(count);
+    size_t maxEntityID = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        mPoints[i]    = positions[mOrder[i]];
+        mEntityIDs[i] = entities[mOrder[i]];
+        maxEntityID = std::max(maxEntityID, mEntityIDs[i]);
+    }
+
+    mSlots.assign(maxEntityID + 1, 0);
+    for(uint32_t i = 0; i < count; i++) {
+        mSlots[mEntityIDs[i]] = i;
+    }
+
+    for(uint32_t i = 0; i < mNodes.size(); i++) {
+        if(mNodes[i].right == 0) {
+            mLeaves.push_back(i);
+        }
+    }
+
+    Fit();
+}
+
+bool KdTreeNeighborSearch::Refit(bismuth::Registry& registry) {
+    auto& spherePool = registry.GetComponentPool<SphereComponent>();
+    if(spherePool.GetDenseEntities().size() != mEntityIDs.size()) {
+        return false;
+    }
+
+    std::atomic<bool> valid = true;
+    quartz::TaskPool::Get().ParallelFor(0, mEntityIDs.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            if(!registry.HasComponent<SphereComponent>(mEntityIDs[i])) {
+                valid = false;
+                return;
+            }
+            mPoints[i] = glm::vec3(spherePool.GetComponent(mEntityIDs[i]).positionAndRadius);
+        }
+    });
+
+    if(!valid) {
+        return false;
+    }
+
+    Fit();
+    return true;
+}
+
+uint32_t KdTreeNeighborSearch::CountNodes(uint32_t count) {
+    if(count <= sapphire_config::KD_TREE_LEAF_SIZE) {
+        return 1;
+    }
+    return 1 + CountNodes(count / 2) + CountNodes(count - count / 2);
+}
+
+void KdTreeNeighborSearch::BuildNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, std::vector<glm::vec3> const& positions) {
+    if(end - begin <= sapphire_config::KD_TREE_LEAF_SIZE) {
+        mNodes[nodeIndex].begin = begin;
+        mNodes[nodeIndex].end   = end;
+        mNodes[nodeIndex].right = 0;
+        return;
+    }
+
+    const uint32_t middle = SplitNode(nodeIndex, begin, end, positions);
+    BuildNode(nodeIndex + 1, begin, middle, positions);
+    BuildNode(mNodes[nodeIndex].right, middle, end, positions);
+}
+
+uint32_t KdTreeNeighborSearch::SplitNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, std::vector<glm::vec3> const& positions) {
+    glm::vec3 boundsMin( std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+    for(uint32_t i = begin; i < end; i++) {
+        boundsMin = glm::min(boundsMin, positions[mOrder[i]]);
+        boundsMax = glm::max(boundsMax, positions[mOrder[i]]);
+    }
+
+    const glm::vec3 extent = boundsMax - boundsMin;
+    int axis = 0;
+    if(extent.y > extent[axis]) axis = 1;
+    if(extent.z > extent[axis]) axis = 2;
+
+    // Median split keeps the subtree sizes, and so the node layout, independent of the positions
+    const uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(mOrder.begin() + begin, mOrder.begin() + middle, mOrder.begin() + end, [&](uint32_t a, uint32_t b) {
+        return positions[a][axis] < positions[b][axis];
+    });
+
+    Node& node = mNodes[nodeIndex];
+    node.begin = begin;
+    node.end   = end;
+    node.right = nodeIndex + 1 + CountNodes(middle - begin);
+
+    return middle;
+}
+
+void KdTreeNeighborSearch::Fit() {
+    quartz::TaskPool::Get().ParallelFor(0, mLeaves.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            Node& leaf = mNodes[mLeaves[i]];
+
+            leaf.boundsMin = mPoints[leaf.begin];
+            leaf.boundsMax = mPoints[leaf.begin];
+            for(uint32_t point = leaf.begin + 1; point < leaf.end; point++) {
+                leaf.boundsMin = glm::min(leaf.boundsMin, mPoints[point]);
+                leaf.boundsMax = glm::max(leaf.boundsMax, mPoints[point]);
+            }
+        }
+    });
+
+    // Children always come after their parent
+    for(size_t i = mNodes.size(); i-- > 0;) {
+        Node& node = mNodes[i];
+        if(node.right == 0) {
+            continue;
+        }
+        const Node& left  = mNodes[i + 1];
+        const Node& right = mNodes[node.right];
+        node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+        node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+    }
+}
+
+float KdTreeNeighborSearch::LeafSurfaceArea() const {
+    float area = 0.0f;
+    for(const auto& leafIndex : mLeaves) {
+        const glm::vec3 extent = mNodes[leafIndex].boundsMax - mNodes[leafIndex].boundsMin;
+        area += 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+    return area;
+}
+
+void KdTreeNeighborSearch::CollectLeaves(glm::vec3 const& boundsMin, glm::vec3 const& boundsMax, float radius, std::vector<uint32_t>& leaves) const {
+    const float radiusSquared = radius * radius;
+
+    uint32_t stack[64];
+    size_t top = 0;
+    stack[top++] = 0;
+
+    while(top > 0) {
+        const uint32_t nodeIndex = stack[--top];
+        const Node& node = mNodes[nodeIndex];
+
+        if(BoxBoxDistanceSquared(node.boundsMin, node.boundsMax, boundsMin, boundsMax) > radiusSquared) {
+            continue;
+        }
+        if(node.right == 0) {
+            leaves.push_back(nodeIndex);
+            continue;
+        }
+        stack[top++] = node.right;
+        stack[top++] = nodeIndex + 1;
+    }
+}
+
+void KdTreeNeighborSearch::QueryLeaf(Node const& leaf, glm::vec3 const& point, float radiusSquared, std::vector<size_t>& neighbors) const {
+    for(uint32_t i = leaf.begin; i < leaf.end; i++) {
+        const glm::vec3 delta = point - mPoints[i];
+        if(glm::dot(delta, delta) <= radiusSquared) {
+            neighbors.push_back(mEntityIDs[i]);
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#include "sapphire/neighbors/neighbor_search.hpp"
+#include "sapphire/neighbors/grid_neighbor_search.hpp"
+#include "sapphire/neighbors/kd_tree_neighbor_search.hpp"
+
+void INeighborSearch::QueryBatch(
+    std::vector<uint32_t>            const& entityIDs,
+    std::vector<float>               const& radii,
+    std::vector<uint32_t>            const& costs,
+    std::vector<std::vector<size_t>>&       neighbors
+) const {
+    quartz::TaskPool::Get().ParallelForWeighted(costs, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            Query(entityIDs[i], radii[i], neighbors[i]);
+        }
+    });
+}
+
+std::unique_ptr<INeighborSearch> CreateNeighborSearch(NeighborSearchType type) {
+    switch(type) {
+        case NeighborSearchType::KdTree:
+            return std::make_unique<KdTreeNeighborSearch>();
+        case NeighborSearchType::Grid:
+        default:
+            return std::make_unique<GridNeighborSearch>();
+    }
+}
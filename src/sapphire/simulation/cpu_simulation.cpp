@@ -0,0 +1,111 @@
+#include "sapphire/simulation/cpu_simulation.hpp"
+
+CpuSimulation::CpuSimulation(bool reorder, NeighborSearchType neighborSearch) :
+    mParticleSystem(mRegistry),
+    mSphereDataSystem(sapphire_config::KERNEL, sapphire_config::ADAPTIVE_SMOOTHING, neighborSearch),
+    mReorder(reorder) {
+    mRegistry.EmplaceSingleton<TimeStepComponent>();
+}
+
+void CpuSimulation::Step() {
+    FlushSpawnQueue();
+
+    if(sapphire_config::DOMAIN_CULLING) {
+        mDomainCullingSystem.Update(mRegistry);
+    }
+    if(mDecompositionSystem) {
+        mDecompositionSystem->Update(mRegistry);
+    }
+
+    auto& timeStep = mRegistry.GetSingleton<TimeStepComponent>();
+    auto stepStart = std::chrono::steady_clock::now();
+
+    // Between Update and Predict no system holds dense indices
+    if(mReorder && mReorderSystem.Update(mRegistry)) {
+        mSphereDataSystem.ApplyOrder(mReorderSystem.GetOrder());
+    }
+
+    mTimeStepSystem.Update(mRegistry);
+
+    std::chrono::duration<double> waitTime(0.0);
+    if(mDecompositionSystem) {
+        auto waitStart = std::chrono::steady_clock::now();
+        mDecompositionSystem->ReduceTimeStep(mRegistry);
+        waitTime = std::chrono::steady_clock::now() - waitStart;
+    }
+
+    mForceToPosSystem.Predict(mRegistry, timeStep.dt);
+
+    auto gatherStart = std::chrono::steady_clock::now();
+    mSphereDataSystem.Update(mRegistry);
+    std::chrono::duration<double> gatherTime = std::chrono::steady_clock::now() - gatherStart;
+
+    mReorderSystem.RecordGatherTime(gatherTime.count(), mRegistry.GetComponentPool<SphereComponent>().GetDenseEntities().size());
+
+    mForceToPosSystem.Update(mRegistry, timeStep.dt);
+
+    if(mDecompositionSystem) {
+        std::chrono::duration<double> stepTime = std::chrono::steady_clock::now() - stepStart;
+        mDecompositionSystem->RecordStepTime((stepTime - waitTime).count());
+        mDecompositionSystem->RemoveHalos(mRegistry);
+    }
+}
+
+void CpuSimulation::PublishSnapshot() {
+    auto& spherePool = mRegistry.GetComponentPool<SphereComponent>();
+    auto& spheres    = spherePool.GetDenseComponents();
+
+    ParticleSnapshot& snapshot = mSnapshots.GetWriteBuffer();
+    snapshot.positionAndRadius.resize(spheres.size());
+    for(size_t i = 0; i < spheres.size(); i++) {
+        snapshot.positionAndRadius[i] = spheres[i].positionAndRadius;
+    }
+    snapshot.time = mRegistry.GetSingleton<TimeStepComponent>().time;
+
+    mSnapshots.Publish();
+}
+
+void CpuSimulation::QueueParticle(const glm::vec3& position, float mass, const glm::vec4& velocity) {
+    std::lock_guard<std::mutex> lock(mSpawnMutex);
+    mSpawnQueue.push_back({position, mass, velocity});
+}
+
+quartz::TripleBuffer<ParticleSnapshot>& CpuSimulation::GetSnapshots() {
+    return mSnapshots;
+}
+bismuth::Registry& CpuSimulation::GetRegistry() {
+    return mRegistry;
+}
+ParticleSystem& CpuSimulation::GetParticleSystem() {
+    return mParticleSystem;
+}
+DomainCullingSystem& CpuSimulation::GetDomainCullingSystem() {
+    return mDomainCullingSystem;
+}
+
+void CpuSimulation::EnableDecomposition(std::shared_ptr<ITransport> transport) {
+    mDecompositionSystem = std::make_unique<DomainDecompositionSystem>(std::move(transport));
+}
+DomainDecompositionSystem* CpuSimulation::GetDecompositionSystem() const {
+    return mDecompositionSystem.get();
+}
+
+
+// Private
+void CpuSimulation::FlushSpawnQueue() {
+    std::vector<SpawnRequest> requests;
+    {
+        std::lock_guard<std::mutex> lock(mSpawnMutex);
+        requests.swap(mSpawnQueue);
+    }
+
+    for(const auto& request : requests) {
+        mParticleSystem.CreateParticle(
+            request.position.x,
+            request.position.y,
+            request.position.z,
+            request.mass,
+            request.velocity
+        );
+    }
+}
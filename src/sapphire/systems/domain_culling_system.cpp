@@ -0,0 +1,100 @@
+#include "sapphire/systems/domain_culling_system.hpp"
+
+size_t DomainCullingSystem::Update(bismuth::Registry& registry) {
+    auto& spherePool = registry.GetComponentPool<SphereComponent>();
+    auto& sphereIDs  = spherePool.GetDenseEntities();
+
+    mEscaped.clear();
+    std::mutex escapedMutex;
+
+    quartz::TaskPool::Get().ParallelFor(0, sphereIDs.size(), [&](size_t begin, size_t end) {
+        std::vector<uint32_t> localEscaped;
+
+        for(size_t i = begin; i < end; i++) {
+            const glm::vec3 position = glm::vec3(spherePool.GetComponent(sphereIDs[i]).positionAndRadius);
+
+            bool inside = true;
+            for(int axis = 0; axis < 3; axis++) {
+                // Written so that NaN counts as outside
+                inside = inside && position[axis] >= mDomainMin[axis] && position[axis] <= mDomainMax[axis];
+            }
+            if(!inside) {
+                localEscaped.push_back(sphereIDs[i]);
+            }
+        }
+
+        if(!localEscaped.empty()) {
+            std::lock_guard<std::mutex> lock(escapedMutex);
+            mEscaped.insert(mEscaped.end(), localEscaped.begin(), localEscaped.end());
+        }
+    });
+
+    if(mEscaped.empty()) {
+        return 0;
+    }
+
+    // Same log order no matter how the loop was split
+    std::sort(mEscaped.begin(), mEscaped.end());
+
+    if(!mLogPath.empty()) {
+        WriteLog(registry);
+    }
+
+    for(const auto& entityID : mEscaped) {
+        registry.RemoveEntity(entityID);
+    }
+
+    mEscapedCount += mEscaped.size();
+    return mEscaped.size();
+}
+
+void DomainCullingSystem::SetBounds(const glm::vec3& domainMin, const glm::vec3& domainMax) {
+    mDomainMin = domainMin;
+    mDomainMax = domainMax;
+}
+
+void DomainCullingSystem::SetLogPath(const std::string& logPath) {
+    if(mLog.is_open()) {
+        mLog.close();
+    }
+    mLogPath = logPath;
+}
+
+size_t DomainCullingSystem::GetEscapedCount() const {
+    return mEscapedCount;
+}
+
+
+// Private
+void DomainCullingSystem::WriteLog(bismuth::Registry& registry) {
+    if(!mLog.is_open()) {
+        mLog.open(mLogPath, std::ios::trunc);
+        if(!mLog) {
+            std::cerr << "Failed to open escape log: " << mLogPath << std::endl;
+            mLogPath.clear();
+            return;
+        }
+        mLog << "time,id,x,y,z,vx,vy,vz,mass,density,pressure\n";
+    }
+
+    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool     = registry.GetComponentPool<MassComponent>();
+    auto& densityPool  = registry.GetComponentPool<DensityComponent>();
+    auto& pressurePool = registry.GetComponentPool<PressureComponent>();
+
+    const double time = registry.HasSingleton<TimeStepComponent>() ? registry.GetSingleton<TimeStepComponent>().time : 0.0;
+
+    for(const auto& entityID : mEscaped) {
+        const auto& position = spherePool.GetComponent(entityID).positionAndRadius;
+        const auto& velocity = velocityPool.GetComponent(entityID).v;
+
+        mLog << time << ',' << entityID << ','
+             << position.x << ',' << position.y << ',' << position.z << ','
+             << velocity.x << ',' << velocity.y << ',' << velocity.z << ','
+             << massPool.GetComponent(entityID).m << ','
+             << densityPool.GetComponent(entityID).d << ','
+             << pressurePool.GetComponent(entityID).p << '\n';
+    }
+    mLog.flush();
+}
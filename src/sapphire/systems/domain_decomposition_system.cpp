@@ -0,0 +1,310 @@
+#include "sapphire/systems/domain_decomposition_system.hpp"
+
+namespace {
+    constexpr uint32_t KEY_BITS  = 3 * sapphire_config::MORTON_BITS;
+    constexpr uint32_t BIN_SHIFT = KEY_BITS - std::countr_zero(sapphire_config::REBALANCE_BINS);
+    static_assert(std::has_single_bit(sapphire_config::REBALANCE_BINS) && BIN_SHIFT < KEY_BITS);
+
+    template<typename T>
+    std::vector<std::byte> ToBytes(const std::vector<T>& values) {
+        std::vector<std::byte> bytes(values.size() * sizeof(T));
+        std::memcpy(bytes.data(), values.data(), bytes.size());
+        return bytes;
+    }
+
+    template<typename T>
+    std::vector<T> FromBytes(const std::vector<std::byte>& bytes) {
+        std::vector<T> values(bytes.size() / sizeof(T));
+        std::memcpy(values.data(), bytes.data(), values.size() * sizeof(T));
+        return values;
+    }
+}
+
+DomainDecompositionSystem::DomainDecompositionSystem(std::shared_ptr<ITransport> transport, float cellSize) :
+    mTransport(std::move(transport)), mCellSize(cellSize) {
+}
+
+void DomainDecompositionSystem::Update(bismuth::Registry& registry) {
+    // Both checks are collective, every rank takes the same branch
+    if(mSplitters.empty() || RebalanceDue()) {
+        Rebalance(registry);
+    }
+
+    Migrate(registry);
+    SendHalos(registry);
+
+    mStepCount++;
+}
+
+void DomainDecompositionSystem::RemoveHalos(bismuth::Registry& registry) {
+    const std::vector<uint32_t> halos = registry.GetComponentPool<HaloComponent>().GetDenseEntities();
+    for(const auto& entityID : halos) {
+        registry.RemoveEntity(entityID);
+    }
+    mHaloCount = 0;
+}
+
+void DomainDecompositionSystem::ReduceTimeStep(bismuth::Registry& registry) {
+    auto& timeStep = registry.GetSingleton<TimeStepComponent>();
+
+    const std::vector<float> local = {timeStep.dt};
+    const auto incoming = mTransport->Exchange(std::vector<std::vector<std::byte>>(GetSize(), ToBytes(local)));
+
+    float dt = timeStep.dt;
+    for(const auto& message : incoming) {
+        dt = std::min(dt, FromBytes<float>(message)[0]);
+    }
+
+    // TimeStepSystem already advanced the clock by the local step
+    timeStep.time += dt - timeStep.dt;
+    timeStep.dt = dt;
+}
+
+void DomainDecompositionSystem::RecordStepTime(double seconds) {
+    mStepTime += seconds;
+}
+
+bool DomainDecompositionSystem::IsInitialOwner(size_t index) const {
+    return index % GetSize() == static_cast<size_t>(GetRank());
+}
+
+int DomainDecompositionSystem::GetRank() const {
+    return mTransport->GetRank();
+}
+int DomainDecompositionSystem::GetSize() const {
+    return mTransport->GetSize();
+}
+size_t DomainDecompositionSystem::GetHaloCount() const {
+    return mHaloCount;
+}
+
+
+// Private
+int DomainDecompositionSystem::Owner(const glm::ivec3& cell) const {
+    const uint64_t key = sapphire::MortonKey(cell);
+    return std::upper_bound(mSplitters.begin() + 1, mSplitters.end(), key) - (mSplitters.begin() + 1);
+}
+
+bool DomainDecompositionSystem::RebalanceDue() {
+    if(mStepCount == 0 || mStepCount % sapphire_config::REBALANCE_INTERVAL != 0) {
+        return false;
+    }
+
+    const std::vector<double> local = {mStepTime};
+    const auto incoming = mTransport->Exchange(std::vector<std::vector<std::byte>>(GetSize(), ToBytes(local)));
+
+    double slowest = 0.0;
+    double mean = 0.0;
+    for(const auto& message : incoming) {
+        const double stepTime = FromBytes<double>(message)[0];
+        slowest = std::max(slowest, stepTime);
+        mean += stepTime / GetSize();
+    }
+
+    const bool due = mean > 0.0 && slowest > sapphire_config::REBALANCE_IMBALANCE * mean;
+    if(!due) {
+        mStepTime = 0.0;
+    }
+    return due;
+}
+
+void DomainDecompositionSystem::Rebalance(bismuth::Registry& registry) {
+    auto& spherePool = registry.GetComponentPool<SphereComponent>();
+    auto& sphereIDs  = spherePool.GetDenseEntities();
+
+    // Particles on a slow rank weigh more, so its range shrinks
+    if(mStepTime > 0.0 && !sphereIDs.empty()) {
+        mParticleCost = mStepTime / sphereIDs.size();
+    }
+    mStepTime = 0.0;
+
+    std::vector<double> histogram(sapphire_config::REBALANCE_BINS, 0.0);
+    for(const auto& entityID : sphereIDs) {
+        const glm::vec3 position = glm::vec3(spherePool.GetComponent(entityID).positionAndRadius);
+        histogram[sapphire::MortonKey(position, mCellSize) >> BIN_SHIFT] += mParticleCost;
+    }
+
+    const auto incoming = mTransport->Exchange(std::vector<std::vector<std::byte>>(GetSize(), ToBytes(histogram)));
+
+    // Summed in rank order so every rank ends up with identical splitters
+    std::fill(histogram.begin(), histogram.end(), 0.0);
+    for(const auto& message : incoming) {
+        const auto rankHistogram = FromBytes<double>(message);
+        for(size_t bin = 0; bin < histogram.size(); bin++) {
+            histogram[bin] += rankHistogram[bin];
+        }
+    }
+    const double total = std::accumulate(histogram.begin(), histogram.end(), 0.0);
+
+    const int size = GetSize();
+    mSplitters.assign(size + 1, 0);
+    mSplitters[size] = uint64_t(1) << KEY_BITS;
+
+    size_t bin = 0;
+    double cumulative = 0.0;
+    for(int rank = 1; rank < size; rank++) {
+        const double target = total * rank / size;
+        while(bin < histogram.size() && cumulative + histogram[bin] <= target) {
+            cumulative += histogram[bin];
+            bin++;
+        }
+        mSplitters[rank] = uint64_t(bin) << BIN_SHIFT;
+    }
+}
+
+void DomainDecompositionSystem::Migrate(bismuth::Registry& registry) {
+    const int rank = GetRank();
+
+    auto routes = Route(registry, [&](const glm::ivec3& cell, std::vector<int>& ranks) {
+        const int owner = Owner(cell);
+        if(owner != rank) {
+            ranks.push_back(owner);
+        }
+    });
+
+    std::vector<std::vector<std::byte>> outgoing(GetSize());
+    for(int peer = 0; peer < GetSize(); peer++) {
+        outgoing[peer] = ToBytes(Pack(registry, routes[peer]));
+    }
+    for(const auto& route : routes) {
+        for(const auto& entityID : route) {
+            registry.RemoveEntity(entityID);
+        }
+    }
+
+    const auto incoming = mTransport->Exchange(outgoing);
+    for(int peer = 0; peer < GetSize(); peer++) {
+        if(peer != rank) {
+            Unpack(registry, FromBytes<ParticleRecord>(incoming[peer]), false);
+        }
+    }
+}
+
+void DomainDecompositionSystem::SendHalos(bismuth::Registry& registry) {
+    const int rank = GetRank();
+
+    auto routes = Route(registry, [&](const glm::ivec3& cell, std::vector<int>& ranks) {
+        for(int x = -1; x <= 1; x++) {
+            for(int y = -1; y <= 1; y++) {
+                for(int z = -1; z <= 1; z++) {
+                    const int owner = Owner(cell + glm::ivec3(x, y, z));
+                    if(owner != rank && std::find(ranks.begin(), ranks.end(), owner) == ranks.end()) {
+                        ranks.push_back(owner);
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<std::vector<std::byte>> outgoing(GetSize());
+    for(int peer = 0; peer < GetSize(); peer++) {
+        outgoing[peer] = ToBytes(Pack(registry, routes[peer]));
+    }
+
+    const auto incoming = mTransport->Exchange(outgoing);
+
+    mHaloCount = 0;
+    for(int peer = 0; peer < GetSize(); peer++) {
+        if(peer != rank) {
+            const auto records = FromBytes<ParticleRecord>(incoming[peer]);
+            Unpack(registry, records, true);
+            mHaloCount += records.size();
+        }
+    }
+}
+
+template<typename Destinations>
+std::vector<std::vector<uint32_t>> DomainDecompositionSystem::Route(bismuth::Registry& registry, Destinations destinations) {
+    auto& spherePool = registry.GetComponentPool<SphereComponent>();
+    auto& sphereIDs  = spherePool.GetDenseEntities();
+
+    std::vector<std::vector<uint32_t>> routes(GetSize());
+    std::mutex routeMutex;
+
+    quartz::TaskPool::Get().ParallelFor(0, sphereIDs.size(), [&](size_t begin, size_t end) {
+        std::vector<std::vector<uint32_t>> localRoutes(GetSize());
+        std::vector<int> ranks;
+
+        for(size_t i = begin; i < end; i++) {
+            const glm::vec3 position = glm::vec3(spherePool.GetComponent(sphereIDs[i]).positionAndRadius);
+
+            ranks.clear();
+            destinations(sapphire::MortonCell(position, mCellSize), ranks);
+            for(const auto& destination : ranks) {
+                localRoutes[destination].push_back(sphereIDs[i]);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(routeMutex);
+        for(size_t peer = 0; peer < routes.size(); peer++) {
+            routes[peer].insert(routes[peer].end(), localRoutes[peer].begin(), localRoutes[peer].end());
+        }
+    });
+
+    for(auto& route : routes) {
+        std::sort(route.begin(), route.end());
+    }
+    return routes;
+}
+
+std::vector<DomainDecompositionSystem::ParticleRecord> DomainDecompositionSystem::Pack(bismuth::Registry& registry, const std::vector<uint32_t>& entityIDs) const {
+    auto& spherePool    = registry.GetComponentPool<SphereComponent>();
+    auto& precisePool   = registry.GetComponentPool<PrecisePositionComponent>();
+    auto& massPool      = registry.GetComponentPool<MassComponent>();
+    auto& velocityPool  = registry.GetComponentPool<VelocityComponent>();
+    auto& forcePool     = registry.GetComponentPool<ForceComponent>();
+    auto& densityPool   = registry.GetComponentPool<DensityComponent>();
+    auto& pressurePool  = registry.GetComponentPool<PressureComponent>();
+    auto& smoothingPool = registry.GetComponentPool<SmoothingLengthComponent>();
+    auto& energyPool    = registry.GetComponentPool<EnergyComponent>();
+    auto& materialPool  = registry.GetComponentPool<MaterialComponent>();
+    auto& activityPool  = registry.GetComponentPool<ActivityComponent>();
+
+    std::vector<ParticleRecord> records(entityIDs.size());
+    for(size_t i = 0; i < entityIDs.size(); i++) {
+        const uint32_t entityID = entityIDs[i];
+        const glm::vec4& positionAndRadius = spherePool.GetComponent(entityID).positionAndRadius;
+
+        records[i] = {
+            sapphire_config::DOUBLE_PRECISION_POSITIONS ? precisePool.GetComponent(entityID).position : glm::dvec3(glm::vec3(positionAndRadius)),
+            positionAndRadius.w,
+            massPool.GetComponent(entityID).m,
+            velocityPool.GetComponent(entityID).v,
+            forcePool.GetComponent(entityID).f,
+            densityPool.GetComponent(entityID).d,
+            pressurePool.GetComponent(entityID).p,
+            smoothingPool.GetComponent(entityID).h,
+            energyPool.GetComponent(entityID).e,
+            materialPool.GetComponent(entityID).material,
+            activityPool.GetComponent(entityID)
+        };
+    }
+    return records;
+}
+
+void DomainDecompositionSystem::Unpack(bismuth::Registry& registry, const std::vector<ParticleRecord>& records, bool halo) const {
+    ParticleSystem particleSystem(registry);
+
+    for(const auto& record : records) {
+        const uint32_t entityID = particleSystem.CreateParticle(
+            record.position.x,
+            record.position.y,
+            record.position.z,
+            record.mass,
+            record.velocity,
+            record.material,
+            record.energy
+        );
+
+        registry.GetComponentPool<SphereComponent>().GetComponent(entityID).positionAndRadius.w = record.radius;
+        registry.GetComponentPool<ForceComponent>().GetComponent(entityID).f            = record.force;
+        registry.GetComponentPool<DensityComponent>().GetComponent(entityID).d          = record.density;
+        registry.GetComponentPool<PressureComponent>().GetComponent(entityID).p         = record.pressure;
+        registry.GetComponentPool<SmoothingLengthComponent>().GetComponent(entityID).h  = record.smoothingLength;
+        registry.GetComponentPool<ActivityComponent>().GetComponent(entityID)           = record.activity;
+
+        if(halo) {
+            registry.EmplaceComponent<HaloComponent>(entityID);
+        }
+    }
+}
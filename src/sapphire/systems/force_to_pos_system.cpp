@@ -1,24 +1,9 @@
 #include "sapphire/systems/force_to_pos_system.hpp"
 
-void ForceToPosSystem::Update(bismuth::Registry& registry, float deltaTime) {
-    auto& spherePool = registry.GetComponentPool<SphereComponent>();
-    auto& forcePool = registry.GetComponentPool<ForceComponent>();
-    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
-    auto& massPool = registry.GetComponentPool<MassComponent>();
-
-    auto& sphereIDs = spherePool.GetDenseEntities();
-
-    #pragma omp parallel for
-    for(int i = 0; i < sphereIDs.size(); i++) {
-        size_t entityID = sphereIDs[i];
-        
-        glm::vec4& velocity = velocityPool.GetComponent(entityID).v;
-        auto& mass = massPool.GetComponent(entityID).m;
-        auto& force = forcePool.GetComponent(entityID).f;
+void ForceToPosSystem::Predict(bismuth::Registry& registry, float deltaTime) {
+    mIntegrator->Predict(registry, deltaTime);
+}
 
-        glm::vec4 acceleration = force / mass;
-        velocity += acceleration * 0.01f;
-
-        spherePool.GetComponent(entityID).positionAndRadius += velocity * 0.01f;
-    }
-}
\ No newline at end of file
+void ForceToPosSystem::Update(bismuth::Registry& registry, float deltaTime) {
+    mIntegrator->Correct(registry, deltaTime);
+}
@@ -1,199 +1,405 @@
 #include "sapphire/systems/gpu_sphere_data_system.hpp"
+#include <algorithm>
 #include <iostream>
 #include "./quartz/core/components/camera_component.hpp"
 #include "./quartz/core/components/transform_component.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 
-GPUSphereDataSystem::GPUSphereDataSystem(bismuth::Registry& registry) {
-    GLuint densityShader     = shader::CompileShader(GL_COMPUTE_SHADER, "./shaders/compute/density.glsl");
-    GLuint forceShader       = shader::CompileShader(GL_COMPUTE_SHADER, "./shaders/compute/forces.glsl");
-    GLuint forceToPosShader  = shader::CompileShader(GL_COMPUTE_SHADER, "./shaders/compute/force_to_pos.glsl");
-    GLuint spatialHashShader = shader::CompileShader(GL_COMPUTE_SHADER, "./shaders/compute/spatial_hash.glsl");
+GPUSphereDataSystem::GPUSphereDataSystem(
+    bismuth::Registry& registry, 
+    IntegratorType     integrator,
+    bool               adaptiveTimeStep,
+    bool               reorder,
+    KernelType         kernel,
+    bool               tiled,
+    uint32_t           substeps
+) : mIntegrator(integrator), mAdaptiveTimeStep(adaptiveTimeStep), mTiled(tiled), mSubsteps(substeps), mReorder(reorder) {
+    if(!registry.HasSingleton<SimulationParametersComponent>()) {
+        registry.EmplaceSingleton<SimulationParametersComponent>();
+    }
+    mSmoothingLength = registry.GetSingleton<SimulationParametersComponent>().smoothingLength;
+
+    // Fixed for the run, so the compiler can fold them instead of reading uniforms
+    mDefines = {
+        {"WORKGROUP_SIZE",     std::to_string(sapphire_config::WORKGROUP_SIZE) + "u"},
+        {"SMOOTHING_LENGTH",   shader::FloatLiteral(mSmoothingLength)},
+        {"KERNEL_SUPPORT",     shader::FloatLiteral(sapphire::KernelSupport(kernel))},
+        {"CELL_SIZE",          shader::FloatLiteral(mSmoothingLength)},
+        {"INTEGRATOR",         mIntegrator == IntegratorType::SymplecticEuler ? "0" : "1"},
+        {"ADAPTIVE_TIME_STEP", mAdaptiveTimeStep ? "1" : "0"}
+    };
+    if(mTiled) {
+        mDefines.emplace_back("TILED", "");
+    }
+
+    // Kernel functions specialized for the configured kernel and support radius
+    mKernelPrelude = sapphire::GenerateKernelGLSL(kernel, mSmoothingLength);
+
+    // The hash programs wait for the first Simulate, they need the cell table size
+    mPosProgram         = shader::CreateComputeProgram("./shaders/compute/force_to_pos.glsl", mDefines);
+    mTimeStepProgram    = shader::CreateComputeProgram("./shaders/compute/time_step.glsl", mDefines);
+    mMortonProgram      = shader::CreateComputeProgram("./shaders/compute/morton.glsl", mDefines);
+    mPermuteProgram     = shader::CreateComputeProgram("./shaders/compute/permute.glsl", mDefines);
 
     mRender = shader::CreateGraphicsPipeline("./shaders/ssbo_sphere_vert.glsl", "./shaders/instancedFrag.glsl");
 
-    mSpatialHashProgram = shader::LinkProgram(spatialHashShader);
-    mDensityProgram     = shader::LinkProgram(densityShader);
-    mForcesProgram      = shader::LinkProgram(forceShader);
-    mPosProgram         = shader::LinkProgram(forceToPosShader);
+    glGenQueries(1, &mGatherQuery);
+    glGenQueries(1, &mReorderQuery);
 
     // Doesnt render without any vao
     glGenVertexArrays(1, &mDummyVAO);
+
+    // Fetched without filtering, density.glsl interpolates itself so it can extrapolate past the edges
+    const auto& eosTable = sapphire::GetEosTable(sapphire_config::MATERIAL);
+    const glm::uvec2 eosSize = eosTable.GetSize();
+
+    glGenTextures(1, &mEosTexture);
+    glBindTexture(GL_TEXTURE_2D, mEosTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, eosSize.x, eosSize.y, 0, GL_RG, GL_FLOAT, eosTable.GetSamples().data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Uniforms set per dispatch, everything else lives in the parameter buffer
+    mPosStageLocation         = shader::FindUniformLocation(mPosProgram, "uStage");
+    mPosStorePreviousLocation = shader::FindUniformLocation(mPosProgram, "uStorePrevious");
+    mFinalizeLocation         = shader::FindUniformLocation(mTimeStepProgram, "uFinalize");
+
+    if(*sapphire_config::GPU_PROFILER_CSV) {
+        mProfiler.OpenLog(sapphire_config::GPU_PROFILER_CSV);
+    }
 }
 
 void GPUSphereDataSystem::Update(bismuth::Registry& registry, DataBuffers& dataBuffer) {
-    constexpr uint32_t RESET_VALUE = 0xFFFFFFFF;
+    Simulate(registry, dataBuffer);
+    Render(registry, dataBuffer, 1.0f);
+}
 
+void GPUSphereDataSystem::Simulate(bismuth::Registry& registry, DataBuffers& dataBuffer) {
     auto& spherePool = registry.GetComponentPool<SphereComponent>();
     auto& denseEntities = spherePool.GetDenseEntities();
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, dataBuffer.mHashTable);
-    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &RESET_VALUE);
-    
-    ComputeSpatialHash(denseEntities, dataBuffer);
-
-    ComputeDensity(denseEntities, dataBuffer);
-    ComputeForces(denseEntities, dataBuffer);
-    ComputePos(denseEntities, dataBuffer);
-
-    Render(denseEntities, registry, dataBuffer);
+    // The sort and permute passes use their own bindings, so reordering waits for the next call
+    if(mReorder && mReorderScheduler.ShouldReorder()) {
+        mProfiler.Begin("Reorder");
+        Reorder(denseEntities, dataBuffer);
+        mProfiler.End();
+    }
+
+    if(mSpatialHashProgram == 0 || dataBuffer.mCellTableSize != mProgramTableSize) {
+        BuildHashPrograms(dataBuffer.mCellTableSize);
+    }
+
+    // Bindings and parameters hold for every substep
+    BindBuffers(dataBuffer);
+    UploadParameters(registry.GetSingleton<SimulationParametersComponent>(), dataBuffer);
+
+    for(uint32_t substep = 0; substep < mSubsteps; substep++) {
+        mStepCount++;
+        CollectTimings(denseEntities.size());
+
+        // Render interpolates from the positions before the first substep
+        glProgramUniform1ui(mPosProgram, mPosStorePreviousLocation, substep == 0 ? 1u : 0u);
+
+        // Step size is picked on the gpu from the previous step, no readback
+        mProfiler.Begin("TimeStep");
+        ComputeTimeStep(denseEntities);
+        mProfiler.End();
+
+        if(mIntegrator != IntegratorType::SymplecticEuler) {
+            mProfiler.Begin("Integrate");
+            ComputePos(denseEntities, 0);
+            mProfiler.End();
+        }
+
+        // One timer query in flight, results are read a few steps later without stalling
+        const bool timeGather = mReorder && !mGatherQueryPending;
+        if(timeGather) {
+            glBeginQuery(GL_TIME_ELAPSED, mGatherQuery);
+        }
+
+        mProfiler.Begin("Hash");
+        ComputeSpatialHash(denseEntities, dataBuffer);
+        mProfiler.End();
+
+        mProfiler.Begin("Density");
+        ComputeDensity(denseEntities, dataBuffer);
+        mProfiler.End();
+
+        mProfiler.Begin("Forces");
+        ComputeForces(denseEntities, dataBuffer);
+        mProfiler.End();
+
+        if(timeGather) {
+            glEndQuery(GL_TIME_ELAPSED);
+            mGatherQueryPending = true;
+            mGatherQueryStep = mStepCount;
+        }
+
+        mProfiler.Begin("Integrate");
+        ComputePos(denseEntities, 1);
+        mProfiler.End();
+    }
 }
 
 // Private functions
-void GPUSphereDataSystem::BindSpatial(DataBuffers& dataBuffer) {
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, dataBuffer.mSphereData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mHashTable);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dataBuffer.mNextPointers);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, dataBuffer.mBucketKeys);
-    
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, dataBuffer.mSphereLocData);
+void GPUSphereDataSystem::BuildHashPrograms(uint32_t tableSize) {
+    // Only rebuilt when the particle capacity grows, the program cache makes repeats cheap
+    shader::Defines defines = mDefines;
+    defines.emplace_back("HASH_SIZE", std::to_string(tableSize) + "u");
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, dataBuffer.mDenseIDs);
-}
-void GPUSphereDataSystem::BindDensity(DataBuffers& dataBuffer) {
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, dataBuffer.mSphereData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mPressureData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dataBuffer.mDensityData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, dataBuffer.mMassData);
-
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, dataBuffer.mSphereLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, dataBuffer.mPressureLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, dataBuffer.mDensityLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, dataBuffer.mMassLocData);
-
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, dataBuffer.mDenseIDs);
-
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, dataBuffer.mHashTable);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, dataBuffer.mNextPointers);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, dataBuffer.mBucketKeys);
+    glDeleteProgram(mSpatialHashProgram);
+    glDeleteProgram(mDensityProgram);
+    glDeleteProgram(mForcesProgram);
+
+    mSpatialHashProgram = shader::CreateComputeProgram("./shaders/compute/spatial_hash.glsl", defines);
+    mDensityProgram     = shader::CreateComputeProgram("./shaders/compute/density.glsl", defines, mKernelPrelude);
+    mForcesProgram      = shader::CreateComputeProgram("./shaders/compute/forces.glsl", defines, mKernelPrelude);
+
+    mSpatialStageLocation = shader::FindUniformLocation(mSpatialHashProgram, "uStage");
+    mProgramTableSize     = tableSize;
 }
-void GPUSphereDataSystem::BindForce(DataBuffers& dataBuffer) {
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, dataBuffer.mSphereData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mVelocityData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dataBuffer.mPressureData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, dataBuffer.mDensityData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, dataBuffer.mMassData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, dataBuffer.mForceData);
-
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, dataBuffer.mSphereLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, dataBuffer.mVelocityLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, dataBuffer.mPressureLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, dataBuffer.mDensityLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10,dataBuffer.mMassLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11,dataBuffer.mForceLocData);
-    
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, dataBuffer.mDenseIDs);
+void GPUSphereDataSystem::BindBuffers(DataBuffers& dataBuffer) {
+    // One layout shared by every simulation shader
+    dataBuffer.BindParticles(0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mPreviousSphereData);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dataBuffer.mTimeStepData);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, dataBuffer.mCellRanges);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, dataBuffer.mCellKeys);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, dataBuffer.mCellRanks);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, dataBuffer.mSortedIDs);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, dataBuffer.mSortedPositions);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, dataBuffer.mParameterData);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, dataBuffer.mHashTable);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, dataBuffer.mNextPointers);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 15, dataBuffer.mBucketKeys);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, mEosTexture);
 }
-void GPUSphereDataSystem::BindPosToForce(DataBuffers& dataBuffer) {
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, dataBuffer.mSphereData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mVelocityData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dataBuffer.mForceData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, dataBuffer.mMassData);
-
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, dataBuffer.mSphereLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, dataBuffer.mVelocityLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, dataBuffer.mForceLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, dataBuffer.mMassLocData);
-    
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, dataBuffer.mDenseIDs);
+void GPUSphereDataSystem::UploadParameters(const SimulationParametersComponent& parameters, DataBuffers& dataBuffer) {
+    if(mParametersUploaded && parameters == mUploadedParameters) {
+        return;
+    }
+
+    const auto& eosTable = sapphire::GetEosTable(sapphire_config::MATERIAL);
+
+    GPUSimulationParameters gpuParameters{};
+    gpuParameters.eosOrigin       = eosTable.GetOrigin();
+    gpuParameters.eosInverseStep  = eosTable.GetInverseStep();
+    gpuParameters.g               = parameters.g;
+    gpuParameters.energy          = parameters.energy;
+
+    gpuParameters.timeStep        = parameters.timeStep;
+    gpuParameters.soundSpeed      = eosTable.GetReferenceSoundSpeed();
+    gpuParameters.viscosity       = parameters.viscosity;
+    gpuParameters.cflFactor       = parameters.cflFactor;
+    gpuParameters.forceFactor     = parameters.forceFactor;
+    gpuParameters.viscosityFactor = parameters.viscosityFactor;
+    gpuParameters.minTimeStep     = parameters.minTimeStep;
+    gpuParameters.maxTimeStep     = parameters.maxTimeStep;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, dataBuffer.mParameterData);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GPUSimulationParameters), &gpuParameters);
+
+    mUploadedParameters  = parameters;
+    mParametersUploaded  = true;
 }
 
 void GPUSphereDataSystem::ComputeSpatialHash(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer) {
     glUseProgram(mSpatialHashProgram);
 
-    BindSpatial(dataBuffer);
+    // Counts accumulate in the end slots
+    constexpr uint32_t RESET_VALUE = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, dataBuffer.mCellRanges);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &RESET_VALUE);
 
-    int uCellSize = shader::FindUniformLocation(mSpatialHashProgram, "uCellSize");
-    int uHashSize = shader::FindUniformLocation(mSpatialHashProgram, "uHashSize");
+    const uint32_t groupCount = (denseEntities.size() + sapphire_config::WORKGROUP_SIZE-1) / sapphire_config::WORKGROUP_SIZE;
 
-    glUniform1f(uCellSize, sapphire_config::SMOOTHING_LENGTH);
-    glUniform1ui(uHashSize, sapphire_config::HASH_SIZE);
+    // Count particles per key, scan the counts into ranges, scatter into the sorted slots
+    glUniform1ui(mSpatialStageLocation, 0u);
+    glDispatchCompute(groupCount, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
-    glDispatchCompute((denseEntities.size() + sapphire_config::WORKGROUP_SIZE-1) / sapphire_config::WORKGROUP_SIZE, 1, 1);
+    glUniform1ui(mSpatialStageLocation, 1u);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUniform1ui(mSpatialStageLocation, 2u);
+    glDispatchCompute(groupCount, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 }
 void GPUSphereDataSystem::ComputeDensity(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer) {
     glUseProgram(mDensityProgram);
 
-    BindDensity(dataBuffer);
-    
-    // Uniforms
-    int uStiffness   = shader::FindUniformLocation(mDensityProgram, "uStiffness");
-    int uRestDensity = shader::FindUniformLocation(mDensityProgram, "uRestDensity");
-    int uSmoothing   = shader::FindUniformLocation(mDensityProgram, "uSmoothingLength");
+    DispatchNeighborLoop(denseEntities, dataBuffer);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+void GPUSphereDataSystem::ComputeForces(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer) {
+    glUseProgram(mForcesProgram);
 
-    int uCellSize = shader::FindUniformLocation(mDensityProgram, "uCellSize");
-    int uHashSize = shader::FindUniformLocation(mDensityProgram, "uHashSize");
+    DispatchNeighborLoop(denseEntities, dataBuffer);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+void GPUSphereDataSystem::DispatchNeighborLoop(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer) {
+    // Tiled kernels take one workgroup per key, empty keys return right away.
+    // 65535 is the smallest group count limit GL guarantees, the groups stride past it
+    if(mTiled) {
+        glDispatchCompute(std::min<GLuint>(dataBuffer.mCellTableSize, 65535), 1, 1);
+        return;
+    }
+    glDispatchCompute((denseEntities.size() + sapphire_config::WORKGROUP_SIZE-1) / sapphire_config::WORKGROUP_SIZE, 1, 1);
+}
+void GPUSphereDataSystem::ComputePos(const std::vector<uint32_t>& denseEntities, uint32_t stage) {
+    glUseProgram(mPosProgram);
 
-    glUniform1f(uStiffness,   sapphire_config::STIFFNESS);
-    glUniform1f(uRestDensity, sapphire_config::REST_DENSITY);
-    glUniform1f(uSmoothing,   sapphire_config::SMOOTHING_LENGTH);
-    
-    glUniform1f(uCellSize, sapphire_config::SMOOTHING_LENGTH);
-    glUniform1ui(uHashSize, sapphire_config::HASH_SIZE);
+    glUniform1ui(mPosStageLocation, stage);
 
     glDispatchCompute((denseEntities.size() + sapphire_config::WORKGROUP_SIZE-1) / sapphire_config::WORKGROUP_SIZE, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 }
-void GPUSphereDataSystem::ComputeForces(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer) {
-    glUseProgram(mForcesProgram);
+void GPUSphereDataSystem::ComputeTimeStep(const std::vector<uint32_t>& denseEntities) {
+    using sapphire_config::WORKGROUP_SIZE;
 
-    BindForce(dataBuffer);
-    
-    // Uniforms
-    int uSmoothing = shader::FindUniformLocation(mForcesProgram, "uSmoothingLength");
-    int uG         = shader::FindUniformLocation(mForcesProgram, "uG");
+    glUseProgram(mTimeStepProgram);
+
+    if(mAdaptiveTimeStep) {
+        glUniform1ui(mFinalizeLocation, 0u);
+        glDispatchCompute((denseEntities.size() + WORKGROUP_SIZE-1) / WORKGROUP_SIZE, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
 
-    int uCellSize = shader::FindUniformLocation(mForcesProgram, "uCellSize");
-    int uHashSize = shader::FindUniformLocation(mForcesProgram, "uHashSize");
+    glUniform1ui(mFinalizeLocation, 1u);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+void GPUSphereDataSystem::Reorder(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer) {
+    using sapphire_config::WORKGROUP_SIZE;
+    using sapphire_config::MORTON_BITS;
 
-    glUniform1f(uSmoothing, sapphire_config::SMOOTHING_LENGTH);
-    glUniform1f(uG,         sapphire_config::G);
+    const uint32_t count = denseEntities.size();
+    if(count == 0) {
+        return;
+    }
 
-    glUniform1f(uCellSize, sapphire_config::SMOOTHING_LENGTH);
-    glUniform1ui(uHashSize, sapphire_config::HASH_SIZE);
+    const bool timeReorder = !mReorderQueryPending;
+    if(timeReorder) {
+        glBeginQuery(GL_TIME_ELAPSED, mReorderQuery);
+    }
 
-    glDispatchCompute((denseEntities.size() + sapphire_config::WORKGROUP_SIZE-1) / sapphire_config::WORKGROUP_SIZE, 1, 1);
+    // Keys
+    glUseProgram(mMortonProgram);
+
+    dataBuffer.BindParticles(0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mSortKeys);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dataBuffer.mSortValues);
+
+    int uCount      = shader::FindUniformLocation(mMortonProgram, "uCount");
+    int uMortonBits = shader::FindUniformLocation(mMortonProgram, "uMortonBits");
+
+    glUniform1ui(uCount,      count);
+    glUniform1ui(uMortonBits, MORTON_BITS);
+
+    glDispatchCompute((count + WORKGROUP_SIZE-1) / WORKGROUP_SIZE, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    mRadixSort.Sort(dataBuffer.mSortKeys, dataBuffer.mSortValues, count, 3 * MORTON_BITS);
+
+    // One gather moves every field, the entity ids travel with the particles
+    PermuteBuffer(dataBuffer.mParticleData, sizeof(GPUParticle) / sizeof(uint32_t), count, dataBuffer);
+
+    if(timeReorder) {
+        glEndQuery(GL_TIME_ELAPSED);
+        mReorderQueryPending = true;
+        mReorderCount = count;
+    }
+
+    mReorderScheduler.Reordered();
+    mLastReorderStep = mStepCount;
+    mGatherCost = -1.0;
 }
-void GPUSphereDataSystem::ComputePos(const std::vector<uint32_t>& denseEntities, DataBuffers& dataBuffer) {
-    glUseProgram(mPosProgram);
+void GPUSphereDataSystem::PermuteBuffer(GLuint buffer, uint32_t stride, uint32_t count, DataBuffers& dataBuffer) {
+    using sapphire_config::WORKGROUP_SIZE;
 
-    BindPosToForce(dataBuffer);
-    
-    int uTimeStep = shader::FindUniformLocation(mPosProgram, "uTimeStep");
+    glUseProgram(mPermuteProgram);
 
-    glUniform1f(uTimeStep, sapphire_config::TIME_STEP);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mReorderScratch);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dataBuffer.mSortValues);
 
-    glDispatchCompute((denseEntities.size() + sapphire_config::WORKGROUP_SIZE-1) / sapphire_config::WORKGROUP_SIZE, 1, 1);
+    int uStride = shader::FindUniformLocation(mPermuteProgram, "uStride");
+    int uCount  = shader::FindUniformLocation(mPermuteProgram, "uCount");
+
+    glUniform1ui(uStride, stride);
+    glUniform1ui(uCount,  count);
+
+    glDispatchCompute((count + WORKGROUP_SIZE-1) / WORKGROUP_SIZE, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glBindBuffer(GL_COPY_READ_BUFFER,  dataBuffer.mReorderScratch);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, count * stride * sizeof(uint32_t));
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 }
-void GPUSphereDataSystem::Render(const std::vector<uint32_t>& denseEntities, bismuth::Registry& registry, DataBuffers& dataBuffer) {
+void GPUSphereDataSystem::CollectTimings(size_t particleCount) {
+    GLint available = 0;
+
+    if(mReorderQueryPending) {
+        glGetQueryObjectiv(mReorderQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(mReorderQuery, GL_QUERY_RESULT, &nanoseconds);
+            mReorderScheduler.RecordReorderCost(nanoseconds * 1e-9 / mReorderCount);
+            mReorderQueryPending = false;
+        }
+    }
+
+    if(mGatherQueryPending) {
+        glGetQueryObjectiv(mGatherQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(mGatherQuery, GL_QUERY_RESULT, &nanoseconds);
+            // Samples taken before the last reorder describe the old order
+            if(mGatherQueryStep >= mLastReorderStep && particleCount > 0) {
+                mGatherCost = nanoseconds * 1e-9 / particleCount;
+            }
+            mGatherQueryPending = false;
+        }
+    }
+
+    // Steps between samples are charged the latest one
+    if(mGatherCost >= 0.0) {
+        mReorderScheduler.RecordStepCost(mGatherCost);
+    }
+}
+void GPUSphereDataSystem::Render(bismuth::Registry& registry, DataBuffers& dataBuffer, float alpha) {
+    auto& denseEntities       = registry.GetComponentPool<SphereComponent>().GetDenseEntities();
     auto& cameraPool          = registry.GetComponentPool<CameraComponent>();
     auto& cameraTransformPool = registry.GetComponentPool<TransformComponent>();
 
     glUseProgram(mRender);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, dataBuffer.mSphereData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mSphereLocData);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dataBuffer.mDenseIDs);
+    dataBuffer.BindParticles(0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dataBuffer.mPreviousSphereData);
     
     int uProjectionMatrix = shader::FindUniformLocation(mRender, "uProjectionMatrix");
     int uCameraPosition   = shader::FindUniformLocation(mRender, "uCameraPosition");
+    int uAlpha            = shader::FindUniformLocation(mRender, "uAlpha");
 
     auto& cameraProjection = cameraPool.GetDenseComponents()[0].viewProjection;
     auto& cameraPosition   = cameraTransformPool.GetDenseComponents()[0].position;
 
     glUniformMatrix4fv(uProjectionMatrix, 1, GL_FALSE, glm::value_ptr(cameraProjection));
     glUniformMatrix4fv(uCameraPosition,   1, GL_FALSE, glm::value_ptr(cameraPosition));
+    glUniform1f(uAlpha, alpha);
 
     glBindVertexArray(mDummyVAO);
 
+    mProfiler.Begin("Render");
     glEnable(GL_PROGRAM_POINT_SIZE);
     glDrawArrays(GL_POINTS, 0, denseEntities.size());
+    mProfiler.End();
+
+    mProfiler.NextFrame();
 }
\ No newline at end of file
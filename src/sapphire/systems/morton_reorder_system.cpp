@@ -0,0 +1,60 @@
+#include "sapphire/systems/morton_reorder_system.hpp"
+
+bool MortonReorderSystem::Update(bismuth::Registry& registry) {
+    if(!mScheduler.ShouldReorder()) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto& spherePool = registry.GetComponentPool<SphereComponent>();
+    auto& spheres    = spherePool.GetDenseComponents();
+    auto& sphereIDs  = spherePool.GetDenseEntities();
+
+    const size_t count = sphereIDs.size();
+    mKeys.resize(count);
+
+    quartz::TaskPool::Get().ParallelFor(0, count, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            const uint32_t key = sapphire::MortonKey(glm::vec3(spheres[i].positionAndRadius), sapphire_config::SMOOTHING_LENGTH);
+            mKeys[i] = (static_cast<uint64_t>(key) << 32) | i;
+        }
+    });
+
+    std::sort(mKeys.begin(), mKeys.end());
+
+    mOrder.resize(count);
+    mEntityOrder.resize(count);
+    for(size_t i = 0; i < count; i++) {
+        mOrder[i] = static_cast<uint32_t>(mKeys[i]);
+        mEntityOrder[i] = sphereIDs[mOrder[i]];
+    }
+
+    // Every particle pool shares the sphere pool's dense order, copied by the workers that use each range
+    sapphire::ForEachParticlePool(registry, [&](auto& pool) {
+        pool.Reorder(mEntityOrder, sapphire::TaskPoolFor);
+    });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if(count > 0) {
+        mScheduler.RecordReorderCost(elapsed.count() / count);
+    }
+    mScheduler.Reordered();
+
+    return true;
+}
+
+void MortonReorderSystem::RecordGatherTime(double seconds, size_t particleCount) {
+    if(particleCount == 0) {
+        return;
+    }
+    // Per particle so spawning does not read as lost locality
+    mScheduler.RecordStepCost(seconds / particleCount);
+}
+
+const std::vector<uint32_t>& MortonReorderSystem::GetOrder() const {
+    return mOrder;
+}
+uint32_t MortonReorderSystem::GetInterval() const {
+    return mScheduler.GetInterval();
+}
@@ -3,15 +3,25 @@
 ParticleSystem::ParticleSystem(bismuth::Registry& registry) :mRegistry(registry) {
 }
 
-void ParticleSystem::CreateParticle(float x, float y, float z, float mass, glm::vec4 velocity) {
-    size_t sphereEntity = mRegistry.CreateEntity();
+uint32_t ParticleSystem::CreateParticle(double x, double y, double z, float mass, glm::vec4 velocity, MaterialType material, float energy) {
+    uint32_t sphereEntity = mRegistry.CreateEntity();
             
     mRegistry.EmplaceComponent<InstanceComponent>(sphereEntity);
     mRegistry.EmplaceComponent<SphereComponent>(sphereEntity, glm::vec4(x, y, z, 1));
+    if(sapphire_config::DOUBLE_PRECISION_POSITIONS) {
+        mRegistry.EmplaceComponent<PrecisePositionComponent>(sphereEntity, glm::dvec3(x, y, z));
+    }
 
-    mRegistry.EmplaceComponent<DensityComponent>(sphereEntity,  0.0f);
+    // Sound speed is looked up from density before the first density pass
+    mRegistry.EmplaceComponent<DensityComponent>(sphereEntity,  static_cast<float>(sapphire::RestDensity(material)));
     mRegistry.EmplaceComponent<PressureComponent>(sphereEntity, 0.0f);
     mRegistry.EmplaceComponent<MassComponent>(sphereEntity,     mass);
     mRegistry.EmplaceComponent<ForceComponent>(sphereEntity,    glm::vec4(0.0f));
     mRegistry.EmplaceComponent<VelocityComponent>(sphereEntity, velocity);
+    mRegistry.EmplaceComponent<EnergyComponent>(sphereEntity,   energy);
+    mRegistry.EmplaceComponent<MaterialComponent>(sphereEntity, material);
+    mRegistry.EmplaceComponent<ActivityComponent>(sphereEntity);
+    mRegistry.EmplaceComponent<SmoothingLengthComponent>(sphereEntity, sapphire_config::SMOOTHING_LENGTH / sapphire::KernelSupport(sapphire_config::KERNEL));
+
+    return sphereEntity;
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "sapphire/systems/snapshot_render_system.hpp"
+
+SnapshotRenderSystem::SnapshotRenderSystem() {
+    mRender = shader::CreateGraphicsPipeline("./shaders/snapshot_sphere_vert.glsl", "./shaders/instancedFrag.glsl");
+
+    mUniformProjectionMatrix = shader::FindUniformLocation(mRender, "uProjectionMatrix");
+    mUniformCameraPosition   = shader::FindUniformLocation(mRender, "uCameraPosition");
+
+    glGenBuffers(1, &mSnapshotData);
+
+    // Doesnt render without any vao
+    glGenVertexArrays(1, &mDummyVAO);
+}
+
+void SnapshotRenderSystem::Update(bismuth::Registry& registry, quartz::TripleBuffer<ParticleSnapshot>& snapshots) {
+    // Only upload when the simulation thread published something new
+    if(snapshots.Consume()) {
+        const auto& positions = snapshots.GetReadBuffer().positionAndRadius;
+        mParticleCount = positions.size();
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mSnapshotData);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, positions.size() * sizeof(glm::vec4), positions.data(), GL_STREAM_DRAW);
+    }
+
+    if(mParticleCount == 0) {
+        return;
+    }
+
+    auto& cameraPool          = registry.GetComponentPool<CameraComponent>();
+    auto& cameraTransformPool = registry.GetComponentPool<TransformComponent>();
+
+    auto& cameraProjection = cameraPool.GetDenseComponents()[0].viewProjection;
+    auto& cameraPosition   = cameraTransformPool.GetDenseComponents()[0].position;
+
+    glUseProgram(mRender);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mSnapshotData);
+
+    glUniformMatrix4fv(mUniformProjectionMatrix, 1, GL_FALSE, glm::value_ptr(cameraProjection));
+    glUniform3fv(mUniformCameraPosition, 1, glm::value_ptr(cameraPosition));
+
+    glBindVertexArray(mDummyVAO);
+
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glDrawArrays(GL_POINTS, 0, mParticleCount);
+}
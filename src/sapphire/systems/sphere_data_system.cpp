@@ -1,288 +1,443 @@
 #include "sapphire/systems/sphere_data_system.hpp"
 
 void SphereDataSystem::Update(bismuth::Registry& registry) {
+    // One specialization per kernel, the kernel is fixed for the whole step
+    sapphire::DispatchKernel(mKernel, [&](auto kernel) {
+        UpdateWithKernel<decltype(kernel)>(registry);
+    });
+}
+
+template<typename Kernel>
+void SphereDataSystem::UpdateWithKernel(bismuth::Registry& registry) {
     using sapphire_config::SMOOTHING_LENGTH;
+    using sapphire_config::MAX_SUPPORT_RADIUS;
+    using sapphire_config::SMOOTHING_SLACK;
     float softening = 0.1f * SMOOTHING_LENGTH;
+    // SMOOTHING_LENGTH is the support radius when h is not adapted
+    const float defaultSmoothingLength = SMOOTHING_LENGTH / Kernel::SUPPORT;
 
-    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
-    auto& densityPool  = registry.GetComponentPool<DensityComponent>();
-    auto& pressurePool = registry.GetComponentPool<PressureComponent>();
-    auto& forcePool    = registry.GetComponentPool<ForceComponent>();
-    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
-    auto& massPool     = registry.GetComponentPool<MassComponent>();
+    auto& spherePool    = registry.GetComponentPool<SphereComponent>();
+    auto& densityPool   = registry.GetComponentPool<DensityComponent>();
+    auto& pressurePool  = registry.GetComponentPool<PressureComponent>();
+    auto& forcePool     = registry.GetComponentPool<ForceComponent>();
+    auto& velocityPool  = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool      = registry.GetComponentPool<MassComponent>();
+    auto& smoothingPool = registry.GetComponentPool<SmoothingLengthComponent>();
+    auto& energyPool    = registry.GetComponentPool<EnergyComponent>();
+    auto& materialPool  = registry.GetComponentPool<MaterialComponent>();
 
-    // SpatialHash
-    auto& spatialPool = registry.GetComponentPool<SpatialHashComponent>();
-    auto& posPool     = registry.GetComponentPool<PositionComponent>();
 
     auto& sphereIDs   = spherePool.GetDenseEntities();
 
     // Load whole array into cache for performance improvement
     // Dense component arrays
-    auto& positionArray     = spherePool.GetDenseComponents();
+    const sapphire::PositionView positions(registry);
     auto& densityArray      = densityPool.GetDenseComponents();
     auto& pressureArray     = pressurePool.GetDenseComponents();
     auto& velocityArray     = velocityPool.GetDenseComponents();
     auto& massArray         = massPool.GetDenseComponents();
-    auto& spatialArray      = spatialPool.GetDenseComponents();
-    auto& spatialPosArray   = posPool.GetDenseComponents();
+    auto& smoothingArray    = smoothingPool.GetDenseComponents();
 
     // Component locations
-    auto& positionLocations = spherePool.GetComponentLocations();
-    auto& densityLocations  = densityPool.GetComponentLocations();
-    auto& pressureLocations = pressurePool.GetComponentLocations();
-    auto& velocityLocations = velocityPool.GetComponentLocations();
-    auto& massLocations     = massPool.GetComponentLocations();
-    auto& spatialLocations  = spatialPool.GetComponentLocations();
-    auto& spatialPosLoc     = posPool.GetComponentLocations();
+    auto& densityLocations   = densityPool.GetComponentLocations();
+    auto& pressureLocations  = pressurePool.GetComponentLocations();
+    auto& velocityLocations  = velocityPool.GetComponentLocations();
+    auto& massLocations      = massPool.GetComponentLocations();
+    auto& smoothingLocations = smoothingPool.GetComponentLocations();
     
+    // Neighbor counts of the last step are the best guess for the search cost
+    mNeighborCosts.resize(sphereIDs.size(), 0);
+
+    // Dormant particles keep their density, pressure and force, they are left out of every pass
+    auto& activityPool = registry.GetComponentPool<ActivityComponent>();
+    CollectActive(sphereIDs, activityPool);
+
     static std::vector<std::vector<size_t>> neighborsIDs;
     for(auto& neighbors : neighborsIDs) {
         neighbors.clear();
     }
-    if(neighborsIDs.size() != sphereIDs.size()) {
-        neighborsIDs.resize(sphereIDs.size());
+    if(neighborsIDs.size() != mActiveIDs.size()) {
+        neighborsIDs.resize(mActiveIDs.size());
     }
 
-    #pragma omp parallel for
-    for(int i = 0; i < sphereIDs.size(); i++) {
-        size_t entityID = sphereIDs[i];
-        
-        GetNeighbors(
-            entityID,
-            SMOOTHING_LENGTH,
-            neighborsIDs[i],
-            sphereIDs.size(),
-
-            positionArray.data(),
-            spatialPosArray.data(),
-            spatialArray.data(),
-            positionLocations.data(),
-            spatialPosLoc.data(),
-            spatialLocations.data(),
-
-            spatialPool.GetDenseEntities()
-        );
+    // Search radius of every particle, h may grow up to it during this step
+    auto searchRadius = [&](float smoothingLength) {
+        if(!mAdaptiveSmoothing) {
+            return SMOOTHING_LENGTH;
+        }
+        return std::min(Kernel::SUPPORT * smoothingLength * SMOOTHING_SLACK, MAX_SUPPORT_RADIUS);
+    };
+
+    auto& taskPool = quartz::TaskPool::Get();
+
+    mSearchRadii.resize(mActiveIDs.size());
+    taskPool.ParallelFor(0, mActiveIDs.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            float& smoothingLength = smoothingPool.GetComponent(mActiveIDs[i]).h;
+            if(!mAdaptiveSmoothing) {
+                smoothingLength = defaultSmoothingLength;
+            }
+            mSearchRadii[i] = searchRadius(smoothingLength);
+        }
+    });
+
+    mNeighborSearch->Build(registry);
+    mNeighborSearch->QueryBatch(mActiveIDs, mSearchRadii, mActiveCosts, neighborsIDs);
+    for(size_t i = 0; i < mActiveIDs.size(); i++) {
+        mActiveCosts[i] = neighborsIDs[i].size();
     }
 
-    #pragma omp parallel for
-    for(int i = 0; i < sphereIDs.size(); i++) {
-        size_t entityID = sphereIDs[i];
+    taskPool.ParallelForWeighted(mActiveCosts, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = mActiveIDs[i];
+
+            float& pressure = pressurePool.GetComponent(entityID).p;
+            float& density = densityPool.GetComponent(entityID).d;
+            float& smoothingLength = smoothingPool.GetComponent(entityID).h;
+
+            if(mAdaptiveSmoothing) {
+                smoothingLength = SolveSmoothingLength<Kernel>(
+                    entityID,
+                    neighborsIDs[i],
+                    smoothingLength,
+                    searchRadius(smoothingLength) / Kernel::SUPPORT,
+
+                    positions
+                );
+            }
+
+            density = ComputeDensity<Kernel>(
+                entityID,
+                neighborsIDs[i],
+                smoothingLength,
+                massPool.GetComponent(entityID).m,
+            
+                positions
+            );
+            pressure = ComputePressure(
+                density,
+                energyPool.GetComponent(entityID).e,
+                materialPool.GetComponent(entityID).material
+            );
+        }
+    });
+
+    // A pair interacts inside the larger of its two supports. Every particle keeps the candidates
+    // inside its own support, pairs only inside that support are then added to the other side too
+    if(mAdaptiveSmoothing) {
+        constexpr uint32_t INACTIVE = std::numeric_limits<uint32_t>::max();
+        mActiveSlots.assign(smoothingLocations.size(), INACTIVE);
+        for(uint32_t i = 0; i < mActiveIDs.size(); i++) {
+            mActiveSlots[mActiveIDs[i]] = i;
+        }
+        mReverseNeighbors.resize(mActiveIDs.size());
+
+        taskPool.ParallelForWeighted(mActiveCosts, [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++) {
+                const size_t entityID = mActiveIDs[i];
+                const float support = Kernel::SUPPORT * smoothingArray[smoothingLocations[entityID]].h;
 
-        float& pressure = pressurePool.GetComponent(entityID).p;
-        float& density = densityPool.GetComponent(entityID).d;
+                FilterNeighbors(entityID, neighborsIDs[i], support, positions);
 
-        density = ComputeDensity(
-            entityID,
-            neighborsIDs[i],
-            SMOOTHING_LENGTH,
-            massPool.GetComponent(entityID).m,
-            
-            positionArray.data(),
-            positionLocations.data()
-        );
-        pressure = ComputePressure(density);
+                mReverseNeighbors[i].clear();
+                for(const auto& neighborID : neighborsIDs[i]) {
+                    const uint32_t slot = mActiveSlots[neighborID];
+                    if(slot == INACTIVE) {
+                        continue;
+                    }
+
+                    // Same test as the neighbor's own filter, so it missed exactly these
+                    const float neighborSupport = Kernel::SUPPORT * smoothingArray[smoothingLocations[neighborID]].h;
+                    const glm::vec3 diff = positions.Difference(neighborID, entityID);
+                    if(sapphire::Dot(diff, diff) > neighborSupport * neighborSupport) {
+                        mReverseNeighbors[i].push_back(slot);
+                    }
+                }
+            }
+        });
+
+        for(size_t i = 0; i < mActiveIDs.size(); i++) {
+            for(const auto& slot : mReverseNeighbors[i]) {
+                neighborsIDs[slot].push_back(mActiveIDs[i]);
+            }
+        }
+        for(size_t i = 0; i < mActiveIDs.size(); i++) {
+            mActiveCosts[i] = neighborsIDs[i].size();
+        }
+    }
+
+    taskPool.ParallelForWeighted(mActiveCosts, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = mActiveIDs[i];
+
+            glm::vec4& force = forcePool.GetComponent(entityID).f;
+            force = ComputeForces<Kernel>(
+                entityID,
+                softening,
+                neighborsIDs[i],
+
+                positions,
+                velocityArray.data(),
+                densityArray.data(),
+                pressureArray.data(),
+                massArray.data(),
+                smoothingArray.data(),
+                densityLocations.data(),
+                pressureLocations.data(),
+                velocityLocations.data(),
+                massLocations.data(),
+                smoothingLocations.data()
+            );
+
+            if(mDormancy) {
+                UpdateActivity(
+                    entityID,
+                    glm::vec3(velocityPool.GetComponent(entityID).v),
+                    glm::vec3(force) / massPool.GetComponent(entityID).m,
+                    neighborsIDs[i],
+                    activityPool
+                );
+            }
+        }
+    });
+
+    for(size_t i = 0; i < mActiveIDs.size(); i++) {
+        mNeighborCosts[mActiveIndices[i]] = mActiveCosts[i];
+    }
+
+    if(mDormancy) {
+        FreezeDormant(registry);
+    }
+}
+
+void SphereDataSystem::ApplyOrder(const std::vector<uint32_t>& order) {
+    if(mNeighborCosts.size() != order.size()) {
+        return;
     }
 
-    #pragma omp parallel for
-    for(int i = 0; i < sphereIDs.size(); i++) {
-        size_t entityID = sphereIDs[i];
-
-        glm::vec4& force = forcePool.GetComponent(entityID).f;
-        force = ComputeForces(
-            entityID,
-            SMOOTHING_LENGTH,
-            softening,
-            neighborsIDs[i],
-
-            positionArray.data(),
-            velocityArray.data(),
-            densityArray.data(),
-            pressureArray.data(),
-            massArray.data(),
-            positionLocations.data(),
-            densityLocations.data(),
-            pressureLocations.data(),
-            velocityLocations.data(),
-            massLocations.data()
-        );
+    std::vector<uint32_t> costs(order.size());
+    for(size_t i = 0; i < order.size(); i++) {
+        costs[i] = mNeighborCosts[order[i]];
+    }
+    mNeighborCosts.swap(costs);
+}
+
+void SphereDataSystem::CollectActive(std::vector<uint32_t> const& sphereIDs, bismuth::ComponentPool<ActivityComponent>& activityPool) {
+    mActiveIDs.clear();
+    mActiveIndices.clear();
+    mActiveCosts.clear();
+
+    for(uint32_t i = 0; i < sphereIDs.size(); i++) {
+        if(mDormancy) {
+            auto& activity = activityPool.GetComponent(sphereIDs[i]);
+            if(activity.wake) {
+                activity.wake = 0;
+                activity.dormant = 0;
+                activity.calmSteps = 0;
+            }
+            if(activity.dormant) {
+                continue;
+            }
+        }
+        mActiveIDs.push_back(sphereIDs[i]);
+        mActiveIndices.push_back(i);
+        mActiveCosts.push_back(mNeighborCosts[i]);
     }
 }
 
-void SphereDataSystem::CheckNeighbor(int currentChunk, int& chunkNeighbor, int& neighbor) {
-    if(neighbor < sapphire_config::SPATIAL_LENGTH && neighbor >= 0) {
-        chunkNeighbor = currentChunk;
-    } else if(neighbor < 0) {
-        chunkNeighbor = currentChunk-1;
-        neighbor = sapphire_config::SPATIAL_LENGTH-1;
+void SphereDataSystem::UpdateActivity(
+    size_t                                     entityID,
+    glm::vec3                           const& velocity,
+    glm::vec3                           const& acceleration,
+    std::vector<size_t>                 const& neighbors,
+    bismuth::ComponentPool<ActivityComponent>& activityPool
+) {
+    using namespace sapphire_config;
+
+    const float speedSquared        = glm::dot(velocity, velocity);
+    const float accelerationSquared = glm::dot(acceleration, acceleration);
+
+    // Lively particles wake every frozen neighbor for the next step
+    const float wakeSpeed        = WAKE_FACTOR * DORMANT_SPEED;
+    const float wakeAcceleration = WAKE_FACTOR * DORMANT_ACCELERATION;
+    if(speedSquared > wakeSpeed * wakeSpeed || accelerationSquared > wakeAcceleration * wakeAcceleration) {
+        for(const auto& neighborID : neighbors) {
+            std::atomic_ref<uint32_t>(activityPool.GetComponent(neighborID).wake).store(1, std::memory_order_relaxed);
+        }
+    }
+
+    auto& activity = activityPool.GetComponent(entityID);
+    if(speedSquared < DORMANT_SPEED * DORMANT_SPEED && accelerationSquared < DORMANT_ACCELERATION * DORMANT_ACCELERATION) {
+        activity.calmSteps++;
     } else {
-        chunkNeighbor = currentChunk+1;
-        neighbor = 0;
+        activity.calmSteps = 0;
+    }
+    if(activity.calmSteps >= DORMANT_STEPS) {
+        activity.dormant = 1;
     }
 }
 
-void SphereDataSystem::GetNeighbors(
-    size_t               const& currentPointID,
-    float                       radius,
-    std::vector<size_t>&        neighbors, 
-    size_t               const& maxParticles,
+void SphereDataSystem::FreezeDormant(bismuth::Registry& registry) {
+    auto& activityPool = registry.GetComponentPool<ActivityComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& forcePool    = registry.GetComponentPool<ForceComponent>();
+
+    // Velocities are read by neighbors during the force pass, so particles only stop once it is done
+    for(const auto& entityID : mActiveIDs) {
+        if(activityPool.GetComponent(entityID).dormant) {
+            velocityPool.GetComponent(entityID).v = glm::vec4(0.0f);
+            forcePool.GetComponent(entityID).f    = glm::vec4(0.0f);
+        }
+    }
+}
 
-    SphereComponent      const* positionArray,
-    PositionComponent    const* spatialPosArray,
-    SpatialHashComponent const* spatialHashArray,
-    uint32_t             const* positionLocations,
-    uint32_t             const* spatialPositionLoc,
-    uint32_t             const* spatialHashLocations,
+template<typename Kernel>
+float SphereDataSystem::SolveSmoothingLength(
+    size_t              const& currentPointID,
+    std::vector<size_t> const& candidateIDs,
+    float                      smoothingLength,
+    float                      maxSmoothingLength,
 
-    std::vector<uint32_t>  const& spatialDenseEntities
+    sapphire::PositionView const& positions
 ) {
-    using sapphire_config::SPATIAL_LENGTH;
-    using sapphire_config::SPATIAL_LENGTH_MAX;
+    using namespace sapphire_config;
 
-    size_t count = 0;
-    // neighbors.resize(maxParticles);
-    size_t* tmp = (size_t*)alloca(maxParticles * sizeof(size_t));  
+    // Number density sum W = (eta/h)^3 puts TARGET_NEIGHBORS inside the support
+    constexpr float eta3 = 3.0f * TARGET_NEIGHBORS / (4.0f * sapphire::PI * Kernel::SUPPORT * Kernel::SUPPORT * Kernel::SUPPORT);
+    const float minSmoothingLength = MIN_SUPPORT_RADIUS / Kernel::SUPPORT;
 
-    float radiusSquaredMax = radius * radius;
-    glm::vec3 currentPos = glm::vec3(positionArray[positionLocations[currentPointID]].positionAndRadius);
+    float h = std::clamp(smoothingLength, minSmoothingLength, maxSmoothingLength);
 
-    // Translate global to local spatial space
-    int chunkY = std::floor(currentPos.y / SPATIAL_LENGTH_MAX);
-    int chunkX = std::floor(currentPos.x / SPATIAL_LENGTH_MAX);
-    int chunkZ = std::floor(currentPos.z / SPATIAL_LENGTH_MAX);
-    
-    float localPosX = currentPos.x - SPATIAL_LENGTH_MAX*chunkX;
-    float localPosY = currentPos.y - SPATIAL_LENGTH_MAX*chunkY;
-    float localPosZ = currentPos.z - SPATIAL_LENGTH_MAX*chunkZ;
-    
-    int cubeX = std::floor(SPATIAL_LENGTH * (localPosX / SPATIAL_LENGTH_MAX));
-    int cubeY = std::floor(SPATIAL_LENGTH * (localPosY / SPATIAL_LENGTH_MAX));
-    int cubeZ = std::floor(SPATIAL_LENGTH * (localPosZ / SPATIAL_LENGTH_MAX));
-
-    for(int localX = -1; localX < 2; localX++) {
-        for(int localY = -1; localY < 2; localY++) {
-            for(int localZ = -1; localZ < 2; localZ++) {
-                int neighborX = cubeX + localX;
-                int neighborY = cubeY + localY;
-                int neighborZ = cubeZ + localZ;
-
-                int chunkNeighborX;
-                int chunkNeighborY;
-                int chunkNeighborZ;
-
-                CheckNeighbor(chunkX, chunkNeighborX, neighborX);
-                CheckNeighbor(chunkY, chunkNeighborY, neighborY);
-                CheckNeighbor(chunkZ, chunkNeighborZ, neighborZ);
-
-                glm::vec3 chunkKey(chunkNeighborX, chunkNeighborY, chunkNeighborZ);
-                int flatIndex = SpatialHash::GetCoordinates(neighborX, neighborY, neighborZ);
-                
-                for(const auto& spatialID : spatialDenseEntities) {
-                    const auto& spatialPos = spatialPosArray[spatialPositionLoc[spatialID]].position;
-
-                    if(spatialPos != chunkKey) {
-                        continue;
-                    }
-                    
-                    const auto& spatial = spatialHashArray[spatialHashLocations[spatialID]];
-                    const auto& entityArray = spatial.flatArrayIDs[flatIndex];
-                    
-                    for(const auto& ID : entityArray) {
-                        const glm::vec3 point = currentPos - glm::vec3(positionArray[positionLocations[ID]].positionAndRadius);
-                        const float radiusSquared = sapphire::Dot(point, point);
-                        
-                        if(radiusSquared <= radiusSquaredMax) {
-                            tmp[count] = ID;
-                            count++;
-                        }
-                    } 
-                }
-            }   
+    for(int iteration = 0; iteration < SMOOTHING_ITERATIONS; iteration++) {
+        float sum = 0.0f;
+        float sumDerivative = 0.0f;
+
+        for(const auto& candidateID : candidateIDs) {
+            glm::vec3 diff = positions.Difference(currentPointID, candidateID);
+            float radius = sapphire::Length(diff, diff);
+
+            sum           += Kernel::W(radius, h);
+            sumDerivative += Kernel::DerivativeH(radius, h);
         }
-    }
 
-    neighbors.resize(count);
-    if (count > 0) {
-        memcpy(neighbors.data(),
-                    tmp,
-                    count * sizeof(size_t));
+        const float target = eta3 / (h*h*h);
+        const float residual = sum - target;
+        const float derivative = sumDerivative + 3.0f * target / h;
+
+        if(derivative == 0.0f) {
+            break;
+        }
+
+        // Newton step, limited so one bad iteration can not collapse or blow up h
+        float next = std::clamp(h - residual / derivative, 0.5f * h, 2.0f * h);
+        next = std::clamp(next, minSmoothingLength, maxSmoothingLength);
+
+        const bool converged = std::abs(next - h) < SMOOTHING_TOLERANCE * h;
+        h = next;
+        if(converged) {
+            break;
+        }
     }
+
+    return h;
 }
-float SphereDataSystem::ComputePressure(float& density) {
-    return sapphire_config::STIFFNESS * (density - sapphire_config::REST_DENSITY);
+
+void SphereDataSystem::FilterNeighbors(
+    size_t               const& currentPointID,
+    std::vector<size_t>&        neighbors,
+    float                       radius,
+
+    sapphire::PositionView const& positions
+) {
+    const float radiusSquaredMax = radius * radius;
+
+    std::erase_if(neighbors, [&](size_t neighborID) {
+        const glm::vec3 diff = positions.Difference(currentPointID, neighborID);
+        return sapphire::Dot(diff, diff) > radiusSquaredMax;
+    });
 }
 
+float SphereDataSystem::ComputePressure(float density, float energy, MaterialType material) {
+    return sapphire::GetEosTable(material).Evaluate(density, energy).pressure;
+}
+
+template<typename Kernel>
 float SphereDataSystem::ComputeDensity(
     size_t              const& currentPointID,
     std::vector<size_t> const& neighborIDs,
     float                      smoothingLength,
     float                      mass,
     
-    SphereComponent     const* positionArray,
-    uint32_t            const* positionLocations
+    sapphire::PositionView const& positions
 ) {
     float density = 0.0f;
 
-    glm::vec3 point = glm::vec3(positionArray[positionLocations[currentPointID]].positionAndRadius);
-
     for(const auto& neighborID : neighborIDs) {
-        glm::vec3 diff = point - glm::vec3(positionArray[positionLocations[neighborID]].positionAndRadius);
+        glm::vec3 diff = positions.Difference(currentPointID, neighborID);
         float radius = sapphire::Length(diff, diff);
 
-        density += mass * sapphire::CubicSplineKernel(radius, smoothingLength);
+        density += mass * Kernel::W(radius, smoothingLength);
     }
 
     return std::max(density, 1e-5f);
 }
 
+template<typename Kernel>
 glm::vec4 SphereDataSystem::ComputeForces(
-    size_t            const&   currentPointID,
-    float                      smoothingLength,
-    float                      softening,
-    std::vector<size_t> const& neighbors,
-
-    SphereComponent   const*   positionArray,
-    VelocityComponent const*   velocityArray,
-    DensityComponent  const*   densityArray,
-    PressureComponent const*   pressureArray,
-    MassComponent     const*   massArray,
-    uint32_t          const*   positionLocations,
-    uint32_t          const*   densityLocations,
-    uint32_t          const*   pressureLocations,
-    uint32_t          const*   velocityLocations,
-    uint32_t          const*   massLocations
+    size_t                   const& currentPointID,
+    float                           softening,
+    std::vector<size_t>      const& neighbors,
+
+    sapphire::PositionView   const& positions,
+    VelocityComponent        const* velocityArray,
+    DensityComponent         const* densityArray,
+    PressureComponent        const* pressureArray,
+    MassComponent            const* massArray,
+    SmoothingLengthComponent const* smoothingArray,
+    uint32_t                 const* densityLocations,
+    uint32_t                 const* pressureLocations,
+    uint32_t                 const* velocityLocations,
+    uint32_t                 const* massLocations,
+    uint32_t                 const* smoothingLocations
 ) {
     glm::vec3 pressureForce(0.0f);
     glm::vec3 viscosityForce(0.0f);
     glm::vec3 gravityForce(0.0f);
 
     float softeningSquared = softening*softening;
-
-    const glm::vec3 point = glm::vec3(positionArray[positionLocations[currentPointID]].positionAndRadius);
+    const float smoothingLength = smoothingArray[smoothingLocations[currentPointID]].h;
 
     const float& currentPointPressure     = pressureArray[pressureLocations[currentPointID]].p;
     const float& currentPointDensity      = densityArray[densityLocations[currentPointID]].d;
     const glm::vec3 currentPointVelocity  = glm::vec3(velocityArray[velocityLocations[currentPointID]].v);
     
     for(const auto& neighborID : neighbors) {
-        glm::vec3 deltaPoint = point - glm::vec3(positionArray[positionLocations[neighborID]].positionAndRadius);
+        glm::vec3 deltaPoint = positions.Difference(currentPointID, neighborID);
         float radiusSquared = sapphire::Dot(deltaPoint, deltaPoint);
         float radius = std::sqrt(radiusSquared);
 
-        if(radius > 0.0f && radius < smoothingLength) {
+        // Same cutoff from both sides of the pair
+        const float neighborSmoothing = smoothingArray[smoothingLocations[neighborID]].h;
+        const float supportRadius     = Kernel::SUPPORT * std::max(smoothingLength, neighborSmoothing);
+
+        if(radius > 0.0f && radius < supportRadius) {
             // Get neighbor components
             const float& neighborDensity      = densityArray[densityLocations[neighborID]].d;
             const float& neighborPressure     = pressureArray[pressureLocations[neighborID]].p;
             const float& neighborMass         = massArray[massLocations[neighborID]].m;
             const glm::vec3 neighborVelocity  = glm::vec3(velocityArray[velocityLocations[neighborID]].v);
 
+            // Kernels of both particles averaged, the force on j is the negative of the force on i
+            const glm::vec3 gradient = 0.5f * (Kernel::Gradient(deltaPoint, radius, smoothingLength) + Kernel::Gradient(deltaPoint, radius, neighborSmoothing));
+            const float laplacian    = 0.5f * (Kernel::Laplacian(radius, smoothingLength) + Kernel::Laplacian(radius, neighborSmoothing));
+
             // Pressure
             float pressureTerm = (currentPointPressure / (currentPointDensity * currentPointDensity)) +
                 (neighborPressure / (neighborDensity * neighborDensity));
-            pressureForce += -pressureTerm * sapphire::CubicSplineGradient(deltaPoint, radius, smoothingLength);
+            pressureForce += -pressureTerm * gradient;
 
             // Viscosity
-            viscosityForce += (neighborDensity * (neighborVelocity - currentPointVelocity)) * sapphire::CubicSplineLaplacian(radius, smoothingLength);
+            viscosityForce += (neighborDensity * (neighborVelocity - currentPointVelocity)) * laplacian;
 
             // Gravity
             float distSoft = radiusSquared + softeningSquared;
@@ -290,5 +445,5 @@ glm::vec4 SphereDataSystem::ComputeForces(
             gravityForce += sapphire_config::G * neighborMass * deltaPoint / denominator;
         }
     }
-    return glm::vec4(pressureForce + viscosityForce + gravityForce, 0.0f);
+    return glm::vec4(pressureForce + sapphire_config::VISCOSITY * viscosityForce + gravityForce, 0.0f);
 }
\ No newline at end of file
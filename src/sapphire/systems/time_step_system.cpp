@@ -0,0 +1,86 @@
+#include "sapphire/systems/time_step_system.hpp"
+
+void TimeStepSystem::Update(bismuth::Registry& registry) {
+    auto& timeStep = registry.GetSingleton<TimeStepComponent>();
+
+    if(!mAdaptive) {
+        timeStep.dt = sapphire_config::TIME_STEP;
+        timeStep.time += timeStep.dt;
+        return;
+    }
+
+    auto& spherePool   = registry.GetComponentPool<SphereComponent>();
+    auto& forcePool    = registry.GetComponentPool<ForceComponent>();
+    auto& velocityPool = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool     = registry.GetComponentPool<MassComponent>();
+    auto& smoothingPool = registry.GetComponentPool<SmoothingLengthComponent>();
+    auto& densityPool  = registry.GetComponentPool<DensityComponent>();
+    auto& energyPool   = registry.GetComponentPool<EnergyComponent>();
+    auto& materialPool = registry.GetComponentPool<MaterialComponent>();
+
+    const float support = sapphire::KernelSupport(sapphire_config::KERNEL);
+
+    auto& sphereIDs = spherePool.GetDenseEntities();
+
+    float maxSpeedSquared = 0.0f;
+    float maxAccelerationSquared = 0.0f;
+    float minSmoothingLength = sapphire_config::SMOOTHING_LENGTH / support;
+    float maxSoundSpeed = 0.0f;
+
+    std::mutex reductionMutex;
+
+    quartz::TaskPool::Get().ParallelFor(0, sphereIDs.size(), [&](size_t begin, size_t end) {
+        float localSpeedSquared = 0.0f;
+        float localAccelerationSquared = 0.0f;
+        float localSmoothingLength = sapphire_config::SMOOTHING_LENGTH / support;
+        float localSoundSpeed = 0.0f;
+
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = sphereIDs[i];
+
+            const glm::vec3 velocity     = glm::vec3(velocityPool.GetComponent(entityID).v);
+            const glm::vec3 acceleration = glm::vec3(forcePool.GetComponent(entityID).f) / massPool.GetComponent(entityID).m;
+
+            localSpeedSquared        = std::max(localSpeedSquared,        glm::dot(velocity, velocity));
+            localAccelerationSquared = std::max(localAccelerationSquared, glm::dot(acceleration, acceleration));
+
+            if(registry.HasComponent<MaterialComponent>(entityID)) {
+                const auto& table = sapphire::GetEosTable(materialPool.GetComponent(entityID).material);
+                localSoundSpeed = std::max(localSoundSpeed, table.Evaluate(densityPool.GetComponent(entityID).d, energyPool.GetComponent(entityID).e).soundSpeed);
+            }
+            if(registry.HasComponent<SmoothingLengthComponent>(entityID)) {
+                localSmoothingLength = std::min(localSmoothingLength, smoothingPool.GetComponent(entityID).h);
+            }
+        }
+
+        // Once per chunk
+        std::lock_guard<std::mutex> lock(reductionMutex);
+        maxSpeedSquared        = std::max(maxSpeedSquared,        localSpeedSquared);
+        maxAccelerationSquared = std::max(maxAccelerationSquared, localAccelerationSquared);
+        minSmoothingLength     = std::min(minSmoothingLength,     localSmoothingLength);
+        maxSoundSpeed          = std::max(maxSoundSpeed,          localSoundSpeed);
+    });
+
+    timeStep.dt = ComputeTimeStep(
+        std::sqrt(maxSpeedSquared),
+        std::sqrt(maxAccelerationSquared),
+        minSmoothingLength,
+        maxSoundSpeed
+    );
+    timeStep.time += timeStep.dt;
+}
+
+float TimeStepSystem::ComputeTimeStep(float maxSpeed, float maxAcceleration, float smoothingLength, float soundSpeed) {
+    using namespace sapphire_config;
+
+    float dt = CFL_FACTOR * smoothingLength / (soundSpeed + maxSpeed);
+
+    if(maxAcceleration > 0.0f) {
+        dt = std::min(dt, FORCE_FACTOR * std::sqrt(smoothingLength / maxAcceleration));
+    }
+    if(VISCOSITY > 0.0f) {
+        dt = std::min(dt, VISCOSITY_FACTOR * smoothingLength * smoothingLength / VISCOSITY);
+    }
+
+    return std::clamp(dt, MIN_TIME_STEP, MAX_TIME_STEP);
+}
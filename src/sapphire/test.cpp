@@ -9,15 +9,16 @@ void TestSystem::Update(bismuth::Registry& registry) {
     auto& instancePool = registry.GetComponentPool<InstanceComponent>();
     auto& spherePool = registry.GetComponentPool<SphereComponent>();
 
-    #pragma omp parallel for
-    for(int i = 0; i < sphereView.SizeHint(); i++) {
-        size_t entityID = (*viewEntities)[i];
-        if(!instancePool.HasComponent(entityID) && !spherePool.HasComponent(entityID)) {
-            continue;
-        }    
+    quartz::TaskPool::Get().ParallelFor(0, sphereView.SizeHint(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            size_t entityID = (*viewEntities)[i];
+            if(!instancePool.HasComponent(entityID) && !spherePool.HasComponent(entityID)) {
+                continue;
+            }    
 
-        spherePool.GetComponent(entityID).positionAndRadius.y -= 0.1f;
-    }
+            spherePool.GetComponent(entityID).positionAndRadius.y -= 0.1f;
+        }
+    });
 
     // for(const auto& [entity, instance, sphere] : spheres) {
     //     // if(sphere.positionAndRadius.z <= -2.0f) {
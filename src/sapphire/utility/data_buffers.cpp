@@ -1,71 +1,48 @@
 #include "sapphire/utility/data_buffers.hpp"
 
 void DataBuffers::Init(bismuth::Registry& registry) {
-    auto& spherePool        = registry.GetComponentPool<SphereComponent>();
-    auto& densityPool       = registry.GetComponentPool<DensityComponent>();
-    auto& pressurePool      = registry.GetComponentPool<PressureComponent>();
-    auto& forcePool         = registry.GetComponentPool<ForceComponent>();
-    auto& velocityPool      = registry.GetComponentPool<VelocityComponent>();
-    auto& massPool          = registry.GetComponentPool<MassComponent>();
-
-    // Load whole array into cache for performance improvement
-    // Dense component arrays
-    auto& positionArray     = spherePool.GetDenseComponents();
-    auto& densityArray      = densityPool.GetDenseComponents();
-    auto& pressureArray     = pressurePool.GetDenseComponents();
-    auto& velocityArray     = velocityPool.GetDenseComponents();
-    auto& massArray         = massPool.GetDenseComponents();
-    auto& forceArray        = forcePool.GetDenseComponents();
-
-    // Component locations
-    auto& positionLocations = spherePool.GetComponentLocations();
-    auto& densityLocations  = densityPool.GetComponentLocations();
-    auto& pressureLocations = pressurePool.GetComponentLocations();
-    auto& velocityLocations = velocityPool.GetComponentLocations();
-    auto& massLocations     = massPool.GetComponentLocations();
-    auto& forceLocations    = forcePool.GetComponentLocations();
-
-    auto& denseEntities     = spherePool.GetDenseEntities();
-    
-    
-    constexpr uint32_t RESET_VALUE = 0xFFFFFFFF;
-
-    // Data Buffers
-    GenerateBuffers(mSphereData,      positionArray);
-    GenerateBuffers(mMassData,        massArray);
-    GenerateBuffers(mDensityData,     densityArray);
-    GenerateBuffers(mPressureData,    pressureArray);
-    GenerateBuffers(mVelocityData,    velocityArray);
-    GenerateBuffers(mForceData,       forceArray);
-
-    // Location Buffers
-    GenerateBuffers(mSphereLocData,   positionLocations);
-    GenerateBuffers(mMassLocData,     massLocations);
-    GenerateBuffers(mDensityLocData,  densityLocations);
-    GenerateBuffers(mPressureLocData, pressureLocations);
-    GenerateBuffers(mVelocityLocData, velocityLocations);
-    GenerateBuffers(mForceLocData,    forceLocations);
-
-    GenerateBuffers(mDenseIDs,        denseEntities);
+    // Particle Buffers
+    glGenBuffers(1, &mParticleData);
+    glGenBuffers(1, &mPreviousSphereData);
 
     // SpatialHash
-    glGenBuffers(1, &mHashTable);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mHashTable);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, sapphire_config::HASH_SIZE * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
-    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &RESET_VALUE);
-
-    glGenBuffers(1, &mNextPointers);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mNextPointers);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, denseEntities.size() * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
-    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &RESET_VALUE);
-
-    glGenBuffers(1, &mBucketKeys);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBucketKeys);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, denseEntities.size() * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
-    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &RESET_VALUE);
+    glGenBuffers(1, &mCellRanges);
+    glGenBuffers(1, &mCellKeys);
+    glGenBuffers(1, &mCellRanks);
+    glGenBuffers(1, &mSortedIDs);
+    glGenBuffers(1, &mSortedPositions);
+
+    // Integration
+    GPUTimeStep timeStep;
+
+    glGenBuffers(1, &mTimeStepData);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mTimeStepData);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPUTimeStep), &timeStep, GL_DYNAMIC_COPY);
+
+    glGenBuffers(1, &mParameterData);
+    glBindBuffer(GL_UNIFORM_BUFFER, mParameterData);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(GPUSimulationParameters), nullptr, GL_DYNAMIC_DRAW);
+
+    // Reordering
+    glGenBuffers(1, &mSortKeys);
+    glGenBuffers(1, &mSortValues);
+    glGenBuffers(1, &mReorderScratch);
+
+    UpdateBuffers(registry);
+}
+
+bool DataBuffers::RequestSync(size_t particleCount) {
+    return mReadback.Request({
+        {mParticleData, particleCount * sizeof(GPUParticle)}
+    });
 }
 
-void DataBuffers::SyncData(bismuth::Registry& registry) {
+bool DataBuffers::PollSync(bismuth::Registry& registry) {
+    const GPUReadback::Slot* slot = mReadback.Poll();
+    return slot && ApplyReadback(registry, *slot);
+}
+
+bool DataBuffers::ApplyReadback(bismuth::Registry& registry, const GPUReadback::Slot& slot) {
     auto& particlePool     = registry.GetComponentPool<SphereComponent>();
     auto& densityPool      = registry.GetComponentPool<DensityComponent>();
     auto& pressurePool     = registry.GetComponentPool<PressureComponent>();
@@ -73,113 +50,195 @@ void DataBuffers::SyncData(bismuth::Registry& registry) {
     auto& velocityPool     = registry.GetComponentPool<VelocityComponent>();
 
     auto& denseParticleIDs = particlePool.GetDenseEntities();
+    const size_t count     = denseParticleIDs.size();
+
+    // Copied before particles were added or removed
+    if(slot.sizes[0] != count * sizeof(GPUParticle)) {
+        return false;
+    }
+
+    const GPUParticle* particles = reinterpret_cast<const GPUParticle*>(slot.GetData(0));
+
+    // The gpu may have reordered its particles, follow its dense order before copying
+    std::vector<uint32_t> gpuOrder(count);
+    for(size_t i = 0; i < count; i++) {
+        gpuOrder[i] = particles[i].entity;
+    }
 
-    const size_t sphereSize   = denseParticleIDs.size() * sizeof(SphereComponent);
-    const size_t densitySize  = denseParticleIDs.size() * sizeof(DensityComponent);
-    const size_t pressureSize = denseParticleIDs.size() * sizeof(PressureComponent);
-    const size_t forceSize    = denseParticleIDs.size() * sizeof(ForceComponent);
-    const size_t velocitySize = denseParticleIDs.size() * sizeof(VelocityComponent);
+    if(gpuOrder != denseParticleIDs) {
+        particlePool.Reorder(gpuOrder);
+        densityPool.Reorder(gpuOrder);
+        pressurePool.Reorder(gpuOrder);
+        forcePool.Reorder(gpuOrder);
+        velocityPool.Reorder(gpuOrder);
+        registry.GetComponentPool<MassComponent>().Reorder(gpuOrder);
+    }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mSphereData);
-    glm::vec4* posPtr = static_cast<glm::vec4*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, sphereSize, GL_MAP_READ_BIT));
-    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    // Every pool shares the gpu order now, mass is never written by the gpu
+    const GPUParticle* particle = particles;
+
+    auto posIt      = particlePool.ComponentBegin();
+    auto densityIt  = densityPool.ComponentBegin();
+    auto pressureIt = pressurePool.ComponentBegin();
+    auto forceIt    = forcePool.ComponentBegin();
+    auto velocityIt = velocityPool.ComponentBegin();
+    for(size_t i = 0; i < count; i++, particle++) {
+        (posIt++)->positionAndRadius = particle->positionAndRadius;
+        (densityIt++)->d             = particle->density;
+        (pressureIt++)->p            = particle->pressure;
+        (forceIt++)->f               = particle->force;
+        (velocityIt++)->v            = particle->velocity;
+    }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mDensityData);
-    float* densityPtr = static_cast<float*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, densitySize, GL_MAP_READ_BIT));
-    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    return true;
+}
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mPressureData);
-    float* pressurePtr = static_cast<float*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, pressureSize, GL_MAP_READ_BIT));
-    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+void DataBuffers::UpdateBuffers(bismuth::Registry& registry) {
+    const size_t count = registry.GetComponentPool<SphereComponent>().GetDenseEntities().size();
+
+    // Everything is overwritten, growing needs no copies
+    ReserveParticles(count, false);
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mForceData);
-    glm::vec4* forcePtr = static_cast<glm::vec4*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, forceSize, GL_MAP_READ_BIT));
-    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    PackParticles(registry, 0, count);
+    UploadParticles(0);
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mVelocityData);
-    glm::vec4* velocityPtr = static_cast<glm::vec4*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, velocitySize, GL_MAP_READ_BIT));
-    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    mParticleCount = count;
+}
 
-    auto posBegin = particlePool.ComponentBegin();
-    auto posEnd   = particlePool.ComponentEnd();
-    for(auto it = posBegin; it != posEnd; ++it) {
-        it->positionAndRadius = *posPtr++;
+void DataBuffers::AppendParticles(bismuth::Registry& registry) {
+    // New particles sit at the end of the sphere pool, they take the slots after
+    // the gpu's particles whatever order the gpu put those in
+    const size_t first = mParticleCount;
+    const size_t count = registry.GetComponentPool<SphereComponent>().GetDenseEntities().size();
+    if(count <= first) {
+        return;
     }
 
-    auto densityBegin = densityPool.ComponentBegin();
-    auto densityEnd   = densityPool.ComponentEnd();
-    for(auto it = densityBegin; it != densityEnd; ++it) {
-        it->d = *densityPtr++;
+    ReserveParticles(count, true);
+
+    PackParticles(registry, first, count - first);
+    UploadParticles(first);
+
+    mParticleCount = count;
+}
+
+void DataBuffers::AllocateReorderBuffers(size_t particleCount) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mSortKeys);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, particleCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mSortValues);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, particleCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mReorderScratch);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, particleCount * sizeof(GPUParticle), nullptr, GL_DYNAMIC_COPY);
+}
+
+void DataBuffers::AllocateCellGrid(size_t particleCount) {
+    mCellTableSize = 1;
+    while(mCellTableSize < particleCount * sapphire_config::CELL_TABLE_FACTOR) {
+        mCellTableSize <<= 1;
     }
 
-    auto pressureBegin = pressurePool.ComponentBegin();
-    auto pressureEnd   = pressurePool.ComponentEnd();
-    for(auto it = pressureBegin; it != pressureEnd; ++it) {
-        it->p = *pressurePtr++;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCellRanges);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, 2 * mCellTableSize * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCellKeys);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, particleCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCellRanks);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, particleCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mSortedIDs);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, particleCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mSortedPositions);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, particleCount * sizeof(SphereComponent), nullptr, GL_DYNAMIC_COPY);
+}
+
+void DataBuffers::BindParticles(GLuint binding) const {
+    // Nothing is dispatched without particles
+    if(mParticleCount == 0) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, mParticleData);
+        return;
     }
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, mParticleData, 0, mParticleCount * sizeof(GPUParticle));
+}
 
-    auto forceBegin = forcePool.ComponentBegin();
-    auto forceEnd   = forcePool.ComponentEnd();
-    for(auto it = forceBegin; it != forceEnd; ++it) {
-        it->f = *forcePtr++;
+void DataBuffers::PackParticles(bismuth::Registry& registry, size_t first, size_t count) {
+    auto& particlePool  = registry.GetComponentPool<SphereComponent>();
+    auto& densityPool   = registry.GetComponentPool<DensityComponent>();
+    auto& pressurePool  = registry.GetComponentPool<PressureComponent>();
+    auto& forcePool     = registry.GetComponentPool<ForceComponent>();
+    auto& velocityPool  = registry.GetComponentPool<VelocityComponent>();
+    auto& massPool      = registry.GetComponentPool<MassComponent>();
+
+    auto& denseEntities = particlePool.GetDenseEntities();
+
+    mPacked.resize(count);
+    mPackedPositions.resize(count);
+
+    // Pools may disagree on order, the locations resolve each entity
+    for(size_t i = 0; i < count; i++) {
+        const uint32_t entity = denseEntities[first + i];
+        GPUParticle& particle = mPacked[i];
+
+        particle.positionAndRadius = particlePool.GetComponent(entity).positionAndRadius;
+        particle.velocity          = velocityPool.GetComponent(entity).v;
+        particle.force             = forcePool.GetComponent(entity).f;
+        particle.density           = densityPool.GetComponent(entity).d;
+        particle.pressure          = pressurePool.GetComponent(entity).p;
+        particle.mass              = massPool.GetComponent(entity).m;
+        particle.entity            = entity;
+
+        mPackedPositions[i] = particle.positionAndRadius;
     }
+}
 
-    auto velocityBegin = velocityPool.ComponentBegin();
-    auto velocityEnd   = velocityPool.ComponentEnd();
-    for(auto it = velocityBegin; it != velocityEnd; ++it) {
-        it->v = *velocityPtr++;
+void DataBuffers::UploadParticles(size_t first) {
+    if(mPacked.empty()) {
+        return;
     }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mParticleData);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * sizeof(GPUParticle), mPacked.size() * sizeof(GPUParticle), mPacked.data());
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mPreviousSphereData);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * sizeof(glm::vec4), mPackedPositions.size() * sizeof(glm::vec4), mPackedPositions.data());
 }
 
-void DataBuffers::UpdateBuffers(bismuth::Registry& registry) {
-    auto& particlePool      = registry.GetComponentPool<SphereComponent>();
-    auto& densityPool       = registry.GetComponentPool<DensityComponent>();
-    auto& pressurePool      = registry.GetComponentPool<PressureComponent>();
-    auto& forcePool         = registry.GetComponentPool<ForceComponent>();
-    auto& velocityPool      = registry.GetComponentPool<VelocityComponent>();
-    auto& massPool          = registry.GetComponentPool<MassComponent>();
-
-    // Dense component arrays
-    auto& positionArray     = particlePool.GetDenseComponents();
-    auto& densityArray      = densityPool.GetDenseComponents();
-    auto& pressureArray     = pressurePool.GetDenseComponents();
-    auto& velocityArray     = velocityPool.GetDenseComponents();
-    auto& forceArray        = forcePool.GetDenseComponents();
-    auto& massArray         = massPool.GetDenseComponents();
-
-    // Component locations
-    auto& positionLocations = particlePool.GetComponentLocations();
-    auto& densityLocations  = densityPool.GetComponentLocations();
-    auto& pressureLocations = pressurePool.GetComponentLocations();
-    auto& velocityLocations = velocityPool.GetComponentLocations();
-    auto& forceLocations    = forcePool.GetComponentLocations();
-    auto& massLocations     = massPool.GetComponentLocations();
-
-    auto& denseEntities     = particlePool.GetDenseEntities();
-    
-    FillBuffer(mSphereData, positionArray);
-    FillBuffer(mDensityData, densityArray);
-    FillBuffer(mPressureData, pressureArray);
-    FillBuffer(mVelocityData, velocityArray);
-    FillBuffer(mForceData, forceArray);
-    FillBuffer(mMassData, massArray);
-    
-    FillBuffer(mSphereLocData, positionLocations);
-    FillBuffer(mDensityLocData, densityLocations);
-    FillBuffer(mPressureLocData, pressureLocations);
-    FillBuffer(mVelocityLocData, velocityLocations);
-    FillBuffer(mForceLocData, forceLocations);
-    FillBuffer(mMassLocData, massLocations);
-
-    FillBuffer(mDenseIDs, denseEntities);
-
-    constexpr uint32_t RESET_VALUE = 0xFFFFFFFF;
-
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mNextPointers);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, denseEntities.size() * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
-    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &RESET_VALUE);
-
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBucketKeys);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, denseEntities.size() * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
-    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &RESET_VALUE);
-}
\ No newline at end of file
+void DataBuffers::ReserveParticles(size_t particleCount, bool keepData) {
+    if(particleCount <= mParticleCapacity) {
+        return;
+    }
+
+    size_t capacity = std::max<size_t>(mParticleCapacity, sapphire_config::MIN_PARTICLE_CAPACITY);
+    while(capacity < particleCount) {
+        capacity *= 2;
+    }
+
+    const size_t keep = keepData ? mParticleCount : 0;
+    ResizeBuffer(mParticleData,       keep * sizeof(GPUParticle), capacity * sizeof(GPUParticle));
+    ResizeBuffer(mPreviousSphereData, keep * sizeof(glm::vec4),   capacity * sizeof(glm::vec4));
+
+    // Rebuilt every step, nothing to keep
+    AllocateCellGrid(capacity);
+    AllocateReorderBuffers(capacity);
+
+    mParticleCapacity = capacity;
+}
+
+void DataBuffers::ResizeBuffer(GLuint& buffer, size_t keepSize, size_t capacity) {
+    GLuint resized;
+    glGenBuffers(1, &resized);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, resized);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_DYNAMIC_COPY);
+
+    // Copied on the gpu, nothing goes through the cpu
+    if(keepSize > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepSize);
+    }
+
+    glDeleteBuffers(1, &buffer);
+    buffer = resized;
+}
@@ -0,0 +1,155 @@
+#include "sapphire/utility/gpu_profiler.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <format>
+#include <iostream>
+
+GPUProfiler::GPUProfiler(uint32_t latency, uint32_t window, bool enabled) : mWindow(window), mFrames(latency + 1) {
+    if(!enabled) {
+        return;
+    }
+
+    // Timestamps can be missing, software implementations report zero bits
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    mEnabled = bits > 0;
+    if(!mEnabled) {
+        std::cerr << "Gpu timestamps are not supported, profiling is disabled" << std::endl;
+    }
+}
+GPUProfiler::~GPUProfiler() {
+    if(!mQueries.empty()) {
+        glDeleteQueries(mQueries.size(), mQueries.data());
+    }
+}
+
+void GPUProfiler::Begin(const std::string& pass) {
+    if(!mEnabled || !mRecording) {
+        return;
+    }
+
+    Sample sample;
+    sample.pass  = FindPass(pass);
+    sample.start = AcquireQuery();
+    sample.end   = AcquireQuery();
+    glQueryCounter(sample.start, GL_TIMESTAMP);
+
+    mFrames[mCurrent].samples.push_back(sample);
+    mOpen = true;
+}
+void GPUProfiler::End() {
+    if(!mOpen) {
+        return;
+    }
+    glQueryCounter(mFrames[mCurrent].samples.back().end, GL_TIMESTAMP);
+    mOpen = false;
+}
+
+void GPUProfiler::NextFrame() {
+    if(!mEnabled) {
+        return;
+    }
+
+    // A skipped frame's slot still holds the older frame
+    if(mRecording) {
+        mFrames[mCurrent].index = mFrameIndex;
+    }
+    mFrameIndex++;
+    mCurrent = (mCurrent + 1) % mFrames.size();
+
+    // The slot now holds the oldest frame, queries finish in order so the last one decides
+    Frame& frame = mFrames[mCurrent];
+    mRecording = true;
+    if(!frame.samples.empty()) {
+        GLint available = 0;
+        glGetQueryObjectiv(frame.samples.back().end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available) {
+            Resolve(frame);
+        } else {
+            mRecording = false;
+        }
+    }
+}
+
+void GPUProfiler::OpenLog(const std::string& path) {
+    mLog.open(path);
+    if(!mLog) {
+        std::cerr << "Failed to open profiler log: " << path << std::endl;
+        return;
+    }
+    mLog << "frame,pass,milliseconds\n";
+}
+
+std::string GPUProfiler::GetSummary() const {
+    std::string summary;
+    for(const Pass& pass : mPasses) {
+        summary += std::format("{} {:.3f} ", pass.name, pass.GetAverage());
+    }
+    return summary + "ms";
+}
+
+// Private
+uint32_t GPUProfiler::FindPass(const std::string& name) {
+    for(uint32_t i = 0; i < mPasses.size(); i++) {
+        if(mPasses[i].name == name) {
+            return i;
+        }
+    }
+
+    Pass pass;
+    pass.name = name;
+    pass.history.assign(mWindow, 0.0);
+    mPasses.push_back(pass);
+    return mPasses.size() - 1;
+}
+
+GLuint GPUProfiler::AcquireQuery() {
+    if(mFreeQueries.empty()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        mQueries.push_back(query);
+        return query;
+    }
+
+    GLuint query = mFreeQueries.back();
+    mFreeQueries.pop_back();
+    return query;
+}
+
+void GPUProfiler::Resolve(Frame& frame) {
+    std::vector<double> totals(mPasses.size(), 0.0);
+
+    for(const Sample& sample : frame.samples) {
+        GLuint64 start = 0;
+        GLuint64 end   = 0;
+        glGetQueryObjectui64v(sample.start, GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(sample.end,   GL_QUERY_RESULT, &end);
+        totals[sample.pass] += (end - start) * 1e-6;
+
+        mFreeQueries.push_back(sample.start);
+        mFreeQueries.push_back(sample.end);
+    }
+
+    // Passes that did not run count as zero, occasional passes average out over the window
+    for(uint32_t i = 0; i < mPasses.size(); i++) {
+        Pass& pass = mPasses[i];
+        pass.sum += totals[i] - pass.history[pass.next];
+        pass.history[pass.next] = totals[i];
+        pass.next  = (pass.next + 1) % mWindow;
+        pass.count = std::min<size_t>(pass.count + 1, mWindow);
+    }
+
+    if(mLog.is_open()) {
+        for(const Sample& sample : frame.samples) {
+            // Written once per pass and frame
+            if(totals[sample.pass] < 0.0) {
+                continue;
+            }
+            mLog << frame.index << "," << mPasses[sample.pass].name << "," << totals[sample.pass] << "\n";
+            totals[sample.pass] = -1.0;
+        }
+    }
+
+    frame.samples.clear();
+}
@@ -0,0 +1,101 @@
+#include "sapphire/utility/gpu_radix_sort.hpp"
+
+GPURadixSort::GPURadixSort() {
+    mProgram = shader::CreateComputeProgram(
+        "./shaders/compute/radix_sort.glsl",
+        {{"WORKGROUP_SIZE", std::to_string(sapphire_config::RADIX_WORKGROUP_SIZE) + "u"}}
+    );
+}
+
+void GPURadixSort::Sort(GLuint keys, GLuint values, uint32_t count, uint32_t keyBits) {
+    using sapphire_config::RADIX_WORKGROUP_SIZE;
+    constexpr uint32_t BITS_PER_PASS = 4;
+
+    if(count == 0) {
+        return;
+    }
+
+    const uint32_t groupCount = (count + RADIX_WORKGROUP_SIZE-1) / RADIX_WORKGROUP_SIZE;
+    Reserve(count, groupCount);
+
+    glUseProgram(mProgram);
+
+    int uStage      = shader::FindUniformLocation(mProgram, "uStage");
+    int uShift      = shader::FindUniformLocation(mProgram, "uShift");
+    int uCount      = shader::FindUniformLocation(mProgram, "uCount");
+    int uGroupCount = shader::FindUniformLocation(mProgram, "uGroupCount");
+
+    glUniform1ui(uCount,      count);
+    glUniform1ui(uGroupCount, groupCount);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, mCounts);
+
+    GLuint sourceKeys        = keys;
+    GLuint sourceValues      = values;
+    GLuint destinationKeys   = mScratchKeys;
+    GLuint destinationValues = mScratchValues;
+
+    for(uint32_t shift = 0; shift < keyBits; shift += BITS_PER_PASS) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sourceKeys);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, sourceValues);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, destinationKeys);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, destinationValues);
+
+        glUniform1ui(uShift, shift);
+
+        glUniform1ui(uStage, 0u);
+        glDispatchCompute(groupCount, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glUniform1ui(uStage, 1u);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glUniform1ui(uStage, 2u);
+        glDispatchCompute(groupCount, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        std::swap(sourceKeys,   destinationKeys);
+        std::swap(sourceValues, destinationValues);
+    }
+
+    // Odd pass count leaves the result in the scratch buffers
+    if(sourceKeys != keys) {
+        glBindBuffer(GL_COPY_READ_BUFFER,  sourceKeys);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, keys);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, count * sizeof(uint32_t));
+
+        glBindBuffer(GL_COPY_READ_BUFFER,  sourceValues);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, values);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, count * sizeof(uint32_t));
+    }
+}
+
+
+// Private
+void GPURadixSort::Reserve(uint32_t count, uint32_t groupCount) {
+    constexpr uint32_t RADIX = 16;
+
+    if(count > mCapacity) {
+        if(mCapacity == 0) {
+            glGenBuffers(1, &mScratchKeys);
+            glGenBuffers(1, &mScratchValues);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mScratchKeys);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mScratchValues);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+
+        mCapacity = count;
+    }
+
+    if(RADIX * groupCount > mCountsCapacity) {
+        if(mCountsCapacity == 0) {
+            glGenBuffers(1, &mCounts);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCounts);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, RADIX * groupCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+
+        mCountsCapacity = RADIX * groupCount;
+    }
+}
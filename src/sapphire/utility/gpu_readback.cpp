@@ -0,0 +1,100 @@
+#include "sapphire/utility/gpu_readback.hpp"
+
+GPUReadback::GPUReadback(uint32_t ringSize) : mSlots(ringSize) {}
+
+bool GPUReadback::Request(std::initializer_list<Source> sources) {
+    Slot& slot = mSlots[mHead];
+
+    // Requests land in order, an in flight head means the whole ring is busy
+    if(slot.fence) {
+        if(!IsSignaled(slot.fence, 0, 0)) {
+            return false;
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    size_t total = 0;
+    slot.offsets.clear();
+    slot.sizes.clear();
+    for(const Source& source : sources) {
+        slot.offsets.push_back(total);
+        slot.sizes.push_back(source.size);
+        // Keeps every source aligned for vec4 reads
+        total += (source.size + 15) & ~size_t(15);
+    }
+    Reserve(slot, total);
+
+    // Copies read what the compute shaders wrote
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+    size_t index = 0;
+    for(const Source& source : sources) {
+        if(source.size > 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, source.buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, slot.offsets[index], source.size);
+        }
+        index++;
+    }
+
+    slot.fence    = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.landed   = false;
+    slot.sequence = ++mSequence;
+
+    mHead = (mHead + 1) % mSlots.size();
+    return true;
+}
+
+const GPUReadback::Slot* GPUReadback::Poll() {
+    Slot* newest = nullptr;
+
+    for(Slot& slot : mSlots) {
+        if(slot.fence && IsSignaled(slot.fence, 0, 0)) {
+            glDeleteSync(slot.fence);
+            slot.fence  = nullptr;
+            slot.landed = true;
+        }
+
+        if(slot.landed && (!newest || slot.sequence > newest->sequence)) {
+            newest = &slot;
+        }
+    }
+
+    // Older copies are superseded
+    for(Slot& slot : mSlots) {
+        slot.landed = false;
+    }
+    return newest;
+}
+
+
+// Private
+void GPUReadback::Reserve(Slot& slot, size_t size) {
+    if(size <= slot.capacity) {
+        return;
+    }
+
+    // Storage is immutable, growing means a new buffer
+    if(slot.buffer) {
+        glDeleteBuffers(1, &slot.buffer);
+    }
+
+    size_t capacity = slot.capacity > 0 ? slot.capacity : 1024;
+    while(capacity < size) {
+        capacity *= 2;
+    }
+
+    constexpr GLbitfield MAP_FLAGS = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &slot.buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, capacity, nullptr, MAP_FLAGS);
+    slot.data = static_cast<std::byte*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, capacity, MAP_FLAGS));
+
+    slot.capacity = capacity;
+}
+bool GPUReadback::IsSignaled(GLsync fence, GLbitfield flags, GLuint64 timeout) {
+    GLenum result = glClientWaitSync(fence, flags, timeout);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
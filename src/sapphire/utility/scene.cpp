@@ -0,0 +1,80 @@
+#include "sapphire/utility/scene.hpp"
+
+namespace {
+    glm::vec3 ReadVec3(const nlohmann::json& value, const glm::vec3& defaultValue) {
+        if(!value.is_array() || value.size() != 3) {
+            return defaultValue;
+        }
+        return glm::vec3(value[0].get<float>(), value[1].get<float>(), value[2].get<float>());
+    }
+
+    NeighborSearchType ReadNeighborSearch(const std::string& name) {
+        if(name == "grid") {
+            return NeighborSearchType::Grid;
+        }
+        if(name == "kd_tree") {
+            return NeighborSearchType::KdTree;
+        }
+        std::cerr << "Unknown neighbor search: " << name << std::endl;
+        exit(1);
+    }
+
+    MaterialType ReadMaterial(const std::string& name) {
+        if(name == "fluid") {
+            return MaterialType::Fluid;
+        }
+        if(name == "basalt") {
+            return MaterialType::Basalt;
+        }
+        if(name == "granite") {
+            return MaterialType::Granite;
+        }
+        if(name == "iron") {
+            return MaterialType::Iron;
+        }
+        std::cerr << "Unknown material: " << name << std::endl;
+        exit(1);
+    }
+}
+
+Scene sapphire::LoadScene(const std::string& scenePath) {
+    std::ifstream sceneFile(scenePath);
+    if (!sceneFile) {
+        std::cerr << "Failed to open scene file: " << scenePath << std::endl;
+        exit(1);
+    }
+
+    nlohmann::json sceneJson;
+    sceneFile >> sceneJson;
+
+    Scene scene;
+    scene.steps           = sceneJson.value("steps", scene.steps);
+    scene.outputInterval  = sceneJson.value("output_interval", scene.outputInterval);
+    scene.outputDirectory = sceneJson.value("output_directory", scene.outputDirectory);
+    if(sceneJson.contains("neighbor_search")) {
+        scene.neighborSearch = ReadNeighborSearch(sceneJson["neighbor_search"].get<std::string>());
+    }
+
+    if(sceneJson.contains("domain")) {
+        const auto& domainJson = sceneJson["domain"];
+        scene.domainMin = ReadVec3(domainJson.value("min", nlohmann::json()), scene.domainMin);
+        scene.domainMax = ReadVec3(domainJson.value("max", nlohmann::json()), scene.domainMax);
+    }
+
+    for(const auto& blockJson : sceneJson["blocks"]) {
+        SceneBlock block;
+        block.center   = ReadVec3(blockJson.value("center", nlohmann::json()), block.center);
+        block.count    = glm::ivec3(ReadVec3(blockJson.value("count", nlohmann::json()), glm::vec3(block.count)));
+        block.spacing  = blockJson.value("spacing", block.spacing);
+        block.mass     = blockJson.value("mass", block.mass);
+        block.velocity = glm::vec4(ReadVec3(blockJson.value("velocity", nlohmann::json()), glm::vec3(0.0f)), 0.0f);
+        block.energy   = blockJson.value("energy", block.energy);
+        if(blockJson.contains("material")) {
+            block.material = ReadMaterial(blockJson["material"].get<std::string>());
+        }
+
+        scene.blocks.push_back(block);
+    }
+
+    return scene;
+}
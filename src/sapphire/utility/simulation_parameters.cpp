@@ -0,0 +1,32 @@
+#include "sapphire/utility/simulation_parameters.hpp"
+
+SimulationParametersComponent sapphire::LoadSimulationParameters(const std::string& configPath) {
+    std::ifstream configFile(configPath);
+    if (!configFile) {
+        std::cerr << "Failed to open configuration file: " << configPath << std::endl;
+        exit(1);
+    }
+
+    nlohmann::json config;
+    configFile >> config;
+
+    SimulationParametersComponent parameters;
+    if(!config.contains("parameters")) {
+        return parameters;
+    }
+
+    const auto& parametersJson = config["parameters"];
+    parameters.smoothingLength = parametersJson.value("smoothing_length", parameters.smoothingLength);
+    parameters.g               = parametersJson.value("g", parameters.g);
+    parameters.energy          = parametersJson.value("energy", parameters.energy);
+
+    parameters.timeStep        = parametersJson.value("time_step", parameters.timeStep);
+    parameters.viscosity       = parametersJson.value("viscosity", parameters.viscosity);
+    parameters.cflFactor       = parametersJson.value("cfl_factor", parameters.cflFactor);
+    parameters.forceFactor     = parametersJson.value("force_factor", parameters.forceFactor);
+    parameters.viscosityFactor = parametersJson.value("viscosity_factor", parameters.viscosityFactor);
+    parameters.minTimeStep     = parametersJson.value("min_time_step", parameters.minTimeStep);
+    parameters.maxTimeStep     = parametersJson.value("max_time_step", parameters.maxTimeStep);
+
+    return parameters;
+}
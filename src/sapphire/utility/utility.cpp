@@ -1,59 +1,35 @@
 #include "sapphire/utility/utility.hpp"
+#include "sapphire/utility/config.hpp"
 
 namespace sapphire {
-    float CubicSplineKernel(const float& radius, const float& smoothingLength) {
-        float q = radius / smoothingLength; // normalizedDistance
-        if (q < 0) return 0.0f;
-        if (q >= 2.0f) return 0.0f;
+    // Inserts two zero bits between each of the low 10 bits
+    static uint32_t SpreadBits(uint32_t x) {
+        x &= 0x000003FF;
+        x = (x | (x << 16)) & 0x030000FF;
+        x = (x | (x << 8))  & 0x0300F00F;
+        x = (x | (x << 4))  & 0x030C30C3;
+        x = (x | (x << 2))  & 0x09249249;
+        return x;
+    }
 
-        const float normalization = 1.0f / (PI * smoothingLength * smoothingLength * smoothingLength);
-        if (q <= 1.0f) {
-            return normalization * (1.0f - 1.5f*q*q + 0.75f*q*q*q);
-        } else {
-            float t = 2.0f - q;
-            return normalization * 0.25f * t * t * t;
-        }
+    uint32_t MortonKey(const glm::vec3& position, float cellSize) {
+        return MortonKey(MortonCell(position, cellSize));
     }
 
-    float CubicSplineDerivative(const float& radius, const float& smoothingLength) {
-        float normalizedDistance = radius / smoothingLength;
-        if(normalizedDistance <= 0.0f || normalizedDistance >= 2.0f) {
-            return 0.0f;
-        }
+    uint32_t MortonKey(const glm::ivec3& cell) {
+        using sapphire_config::MORTON_BITS;
 
-        const float normalization = 1.0f / (PI * smoothingLength * smoothingLength * smoothingLength);
-        
-        if(normalizedDistance <= 1.0f) {
-            return normalization * (-3.0f * normalizedDistance + 2.25f * normalizedDistance * normalizedDistance) / smoothingLength;
-        } else {
-            float factor = 2.0f - normalizedDistance;
-            return -normalization * 0.75f * factor * factor / smoothingLength;
-        }
-    }
+        constexpr int bias = 1 << (MORTON_BITS - 1);
+        constexpr uint32_t mask = (1u << MORTON_BITS) - 1;
 
-    glm::vec3 CubicSplineGradient(const glm::vec3& deltaPoint, const float& radius, const float& smoothingLength) {
-        if(radius == 0.0f) {
-            return glm::vec3(0.0f);
-        }
+        const glm::ivec3 biased = cell + bias;
 
-        float dwdr = CubicSplineDerivative(radius, smoothingLength);
-        return dwdr * (deltaPoint / radius);
+        return  SpreadBits(static_cast<uint32_t>(biased.x) & mask)       |
+               (SpreadBits(static_cast<uint32_t>(biased.y) & mask) << 1) |
+               (SpreadBits(static_cast<uint32_t>(biased.z) & mask) << 2);
     }
 
-    float CubicSplineLaplacian(const float& radius, const float& smoothingLength) {
-        float normalizedDistance = radius / smoothingLength;
-        if(normalizedDistance >= 2.0f) {
-            return 0.0f;
-        }
-        if(normalizedDistance == 0.0f) {
-            return 0.0f;
-        }
-
-        const float normalization = 45.0f / (PI * smoothingLength * smoothingLength * smoothingLength * smoothingLength * smoothingLength);
-        if(normalizedDistance <= 1.0f) {
-            return normalization * (1.0f - normalizedDistance);
-        } else {
-            return normalization * (2.0f - normalizedDistance) * (2.0f - normalizedDistance) * (2.0f - normalizedDistance);
-        }
+    glm::ivec3 MortonCell(const glm::vec3& position, float cellSize) {
+        return glm::ivec3(glm::floor(position / cellSize));
     }
 }
@@ -1,5 +1,7 @@
 // C++ standard libraries
+#include <cassert>
 #include <iostream>
+#include <vector>
 
 // Own libraries
 #include "./bismuth/storage/component_pool.hpp"
@@ -28,5 +30,31 @@ int main() {
         std::cout << *it << std::endl;
     }
 
+    // Entity 0 = 5, 2 = 6, 6 = 7 after the loop above
+    auto checkValues = [&intPool]() {
+        assert(intPool.GetComponent(0) == 5 && "Entity 0 lost its component");
+        assert(intPool.GetComponent(2) == 6 && "Entity 2 lost its component");
+        assert(intPool.GetComponent(6) == 7 && "Entity 6 lost its component");
+    };
+
+    const std::vector<uint32_t> order = {6, 0, 2};
+    intPool.Reorder(order);
+
+    assert(entityDenseArray == order && "Dense order does not match the requested one");
+    checkValues();
+    for(size_t i = 0; i < order.size(); i++) {
+        assert(intPool.GetDenseComponents()[i] == intPool.GetComponent(order[i]) && "Dense components out of order");
+    }
+
+    // Split copy, values must survive whatever thread writes them
+    intPool.FirstTouch([](size_t begin, size_t end, const auto& body) {
+        for(size_t i = begin; i < end; i++) {
+            body(i, i + 1);
+        }
+    });
+
+    assert(entityDenseArray == order && "FirstTouch changed the dense order");
+    checkValues();
+
     std::cout << "FINISHED" << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+// C++ standard libraries
+#include <cassert>
+#include <iostream>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+
+struct PositionComponent{
+    int x;
+    int y;
+};
+
+int main() {
+    bismuth::Registry registry;
+
+    // A removed ID is handed out again, without its old components
+    const size_t entity = registry.CreateEntity();
+    registry.CreateEntity();
+    registry.EmplaceComponent<PositionComponent>(entity, 4, 2);
+
+    registry.RemoveEntity(entity);
+    const size_t recycled = registry.CreateEntity();
+    assert(recycled == entity && "Removed ID was not reused");
+    assert(!registry.HasComponent<PositionComponent>(recycled) && "Recycled ID kept its components");
+
+    // Removing twice frees the ID once
+    registry.RemoveEntity(recycled);
+    registry.RemoveEntity(recycled);
+    const size_t first  = registry.CreateEntity();
+    const size_t second = registry.CreateEntity();
+    assert(first == recycled && "Removed ID was not reused");
+    assert(second != first && "Double remove freed the ID twice");
+
+    // Entities without components are recycled too
+    const size_t empty = registry.CreateEntity();
+    registry.RemoveEntity(empty);
+    assert(registry.CreateEntity() == empty && "Empty entity was not recycled");
+
+    std::cout << "FINISHED" << std::endl;
+}
@@ -0,0 +1,59 @@
+// C++ standard libraries
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+// Third party libraries
+#include <glm/glm.hpp>
+
+// Own libraries
+#include "bismuth/registry.hpp"
+#include "sapphire/systems/particle_system.hpp"
+#include "sapphire/systems/sphere_data_system.hpp"
+
+// A dense block next to a sparse one, so adaptive h differs across the interface
+void CreateBlock(ParticleSystem& particleSystem, glm::vec3 origin, float spacing) {
+    const int size = 6;
+    for(int x = 0; x < size; x++) {
+        for(int y = 0; y < size; y++) {
+            for(int z = 0; z < size; z++) {
+                const glm::vec3 position = origin + spacing * glm::vec3(x, y, z);
+                particleSystem.CreateParticle(position.x, position.y, position.z, 1.0f, glm::vec4(0.0f));
+            }
+        }
+    }
+}
+
+int main() {
+    bismuth::Registry registry;
+    ParticleSystem particleSystem(registry);
+
+    CreateBlock(particleSystem, glm::vec3(0.0f), 0.4f);
+    CreateBlock(particleSystem, glm::vec3(2.4f, 0.0f, 0.0f), 0.8f);
+
+    SphereDataSystem sphereDataSystem(KernelType::CubicSpline, true, NeighborSearchType::KdTree, false);
+    sphereDataSystem.Update(registry);
+
+    float minSmoothingLength = INFINITY;
+    float maxSmoothingLength = 0.0f;
+    for(const auto& smoothing : registry.GetComponentPool<SmoothingLengthComponent>().GetDenseComponents()) {
+        minSmoothingLength = std::min(minSmoothingLength, smoothing.h);
+        maxSmoothingLength = std::max(maxSmoothingLength, smoothing.h);
+    }
+    assert(maxSmoothingLength > 1.5f * minSmoothingLength && "Smoothing lengths did not adapt");
+
+    // Equal masses at rest, every pair force is equal and opposite so the forces cancel
+    glm::vec3 totalForce(0.0f);
+    float totalMagnitude = 0.0f;
+    for(const auto& force : registry.GetComponentPool<ForceComponent>().GetDenseComponents()) {
+        totalForce     += glm::vec3(force.f);
+        totalMagnitude += glm::length(glm::vec3(force.f));
+    }
+
+    std::cout << "h from " << minSmoothingLength << " to " << maxSmoothingLength << std::endl;
+    std::cout << "Net force " << glm::length(totalForce) << " of " << totalMagnitude << std::endl;
+    assert(glm::length(totalForce) < 1e-4f * totalMagnitude && "Pair forces are not symmetric");
+
+    std::cout << "FINISHED" << std::endl;
+}
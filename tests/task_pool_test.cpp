@@ -0,0 +1,73 @@
+// C++ standard libraries
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+// Own libraries
+#include "quartz/core/utils/task_pool.hpp"
+
+int main() {
+    quartz::TaskPool pool(4);
+
+    // Every index is visited exactly once
+    const size_t count = 10'000;
+    std::vector<std::atomic<int>> visits(count);
+    pool.ParallelFor(0, count, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    });
+    for(const auto& visit : visits) {
+        assert(visit == 1 && "ParallelFor missed or repeated an index");
+    }
+
+    // Uneven costs, including zero cost items
+    std::vector<uint32_t> costs(count);
+    for(size_t i = 0; i < count; i++) {
+        costs[i] = (i % 7 == 0) ? 0 : static_cast<uint32_t>(i % 100);
+        visits[i] = 0;
+    }
+    pool.ParallelForWeighted(costs, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    });
+    for(const auto& visit : visits) {
+        assert(visit == 1 && "ParallelForWeighted missed or repeated an index");
+    }
+
+    // Loops started inside a body run serially instead of deadlocking
+    std::atomic<size_t> nestedSum = 0;
+    pool.ParallelFor(0, 64, 1, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            pool.ParallelFor(0, 100, [&](size_t innerBegin, size_t innerEnd) {
+                nestedSum += innerEnd - innerBegin;
+            });
+        }
+    });
+    assert(nestedSum == 64 * 100 && "Nested ParallelFor did not cover its range");
+
+    // Exceptions of any worker reach the caller
+    bool caught = false;
+    try {
+        pool.ParallelFor(0, 64, 1, [](size_t begin, size_t) {
+            if(begin == 37) {
+                throw std::runtime_error("Body failed");
+            }
+        });
+    } catch(const std::runtime_error&) {
+        caught = true;
+    }
+    assert(caught && "Exception of a body was lost");
+
+    // The pool keeps working after a failed loop
+    std::atomic<size_t> sum = 0;
+    pool.ParallelFor(0, count, [&](size_t begin, size_t end) {
+        sum += end - begin;
+    });
+    assert(sum == count && "Pool broke after an exception");
+
+    std::cout << "FINISHED" << std::endl;
+}
@@ -0,0 +1,46 @@
+// C++ standard libraries
+#include <iostream>
+#include <thread>
+#include <cassert>
+
+// Own libraries
+#include "./quartz/core/utils/triple_buffer.hpp"
+
+struct Snapshot {
+    int frame;
+    int checksum; // frame * 2, torn writes would break it
+};
+
+int main() {
+    quartz::TripleBuffer<Snapshot> buffer;
+
+    const int amountOfFrames = 1'000'000;
+
+    std::thread producer([&buffer]() {
+        for(int i = 1; i <= amountOfFrames; i++) {
+            Snapshot& snapshot = buffer.GetWriteBuffer();
+            snapshot.frame    = i;
+            snapshot.checksum = i * 2;
+            buffer.Publish();
+        }
+    });
+
+    int lastFrame = 0;
+    int consumed  = 0;
+    while(lastFrame < amountOfFrames) {
+        if(!buffer.Consume()) {
+            continue;
+        }
+
+        const Snapshot& snapshot = buffer.GetReadBuffer();
+        assert(snapshot.checksum == snapshot.frame * 2 && "Torn snapshot");
+        assert(snapshot.frame > lastFrame && "Snapshot went back in time");
+
+        lastFrame = snapshot.frame;
+        consumed++;
+    }
+    producer.join();
+
+    std::cout << "Consumed " << consumed << " of " << amountOfFrames << " snapshots" << std::endl;
+    std::cout << "FINISHED" << std::endl;
+}